@@ -0,0 +1,59 @@
+/*
+ * DensityHistogram.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "DensityHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+DensityHistogram::DensityHistogram(int width, int height, float minX, float minY, float maxX, float maxY)
+	: colour(1.0f, 1.0f, 1.0f), width(width), height(height), minX(minX), minY(minY),
+	cellsPerUnitX(width / (maxX - minX)), cellsPerUnitY(height / (maxY - minY)),
+	totalPoints(0), counts(static_cast<std::size_t>(width) * height, 0) {
+}
+
+void DensityHistogram::clear() {
+	std::fill(counts.begin(), counts.end(), 0);
+	totalPoints = 0;
+}
+
+void DensityHistogram::addPoints(const glm::vec3* points, std::size_t count) {
+	for (std::size_t i = 0; i < count; i++) {
+		//Compare as floats first so far-away points can't overflow the int conversion
+		float cellX = (points[i][0] - minX) * cellsPerUnitX;
+		float cellY = (points[i][1] - minY) * cellsPerUnitY;
+		if (cellX >= 0.0f && cellX < width && cellY >= 0.0f && cellY < height) {
+			counts[static_cast<std::size_t>(cellY) * width + static_cast<std::size_t>(cellX)]++;
+		}
+	}
+	totalPoints += count;
+}
+
+void DensityHistogram::merge(const DensityHistogram& other) {
+	for (std::size_t i = 0; i < counts.size(); i++) {
+		counts[i] += other.counts[i];
+	}
+	totalPoints += other.totalPoints;
+}
+
+void DensityHistogram::toneMap(std::vector<unsigned char>& intensities) const {
+	intensities.resize(counts.size());
+
+	unsigned int maxCount = 0;
+	for (unsigned int count : counts) {
+		maxCount = std::max(maxCount, count);
+	}
+	if (maxCount == 0) {
+		std::fill(intensities.begin(), intensities.end(), 0);
+		return;
+	}
+
+	//log(1 + count) / log(1 + max) keeps sparse cells visible next to very dense ones
+	float scale = 255.0f / std::log1p(static_cast<float>(maxCount));
+	for (std::size_t i = 0; i < counts.size(); i++) {
+		intensities[i] = static_cast<unsigned char>(std::log1p(static_cast<float>(counts[i])) * scale + 0.5f);
+	}
+}
@@ -0,0 +1,53 @@
+/*
+ * DensityHistogram.h
+ *	Fixed-size 2D grid of hit counts for the chaos-game scenes. Points are binned
+ *	instead of stored, so memory stays constant however many points are generated.
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef DENSITYHISTOGRAM_H_
+#define DENSITYHISTOGRAM_H_
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class DensityHistogram {
+public:
+	//Covers [minX, maxX] x [minY, maxY] in scene coordinates with width x height cells
+	DensityHistogram(int width, int height, float minX, float minY, float maxX, float maxY);
+
+	void clear();
+
+	//Bins the points; points outside the covered area are dropped
+	void addPoints(const glm::vec3* points, std::size_t count);
+
+	//Adds the counts of another histogram with the same dimensions
+	void merge(const DensityHistogram& other);
+
+	//Log-density tone mapping, one byte per cell (0 = empty, 255 = densest cell)
+	void toneMap(std::vector<unsigned char>& intensities) const;
+
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+	std::size_t getTotalPoints() const { return totalPoints; }
+	//Memory held by the counts
+	std::size_t getByteSize() const { return counts.size() * sizeof(unsigned int); }
+
+	//Colour the densest cells are drawn with
+	glm::vec3 colour;
+
+private:
+	int width;
+	int height;
+	float minX;
+	float minY;
+	float cellsPerUnitX;
+	float cellsPerUnitY;
+	std::size_t totalPoints;
+
+	std::vector<unsigned int> counts;
+};
+
+#endif /* DENSITYHISTOGRAM_H_ */
@@ -0,0 +1,352 @@
+/*
+ * FernKernels.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "FernKernels.h"
+
+#include <cstring>
+
+#include "Random.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FERN_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+//Every kernel must round a*x + b*y + e the same way for the backends to agree point for point,
+//so multiplies and adds are never fused (the AVX-512 target would otherwise allow FMA)
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace
+{
+    //Coefficients of the four affine maps, x' = a*x + b*y + e and y' = c*x' + d*y + f
+    //(y' uses the updated x, as the original fern code did), indexed by map number
+    const float MAP_A[4] = {0.85f, 0.20f, -0.15f, 0.00f};
+    const float MAP_B[4] = {0.04f, -0.26f, 0.28f, 0.00f};
+    const float MAP_C[4] = {-0.04f, 0.23f, 0.26f, 0.00f};
+    const float MAP_D[4] = {0.85f, 0.22f, 0.24f, 0.16f};
+    const float MAP_E[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    const float MAP_F[4] = {1.6f, 1.6f, 0.44f, 0.0f};
+
+    //Cumulative probabilities of picking maps 0, 1 and 2
+    const float PROBABILITY_THRESHOLDS[3] = {0.85f, 0.92f, 0.99f};
+
+    const float OFFSET_X = -0.5f;
+    const float OFFSET_Y = -1.5f;
+
+    //Scales a 24 bit integer into [0, 1)
+    const float UNIT_SCALE = 1.0f / 16777216.0f;
+
+    const int LANES = FernKernels::Orbits::MAX_LANES;
+
+    //Steps taken by every lane before its first output point, so orbits start on the attractor
+    const int WARM_UP_STEPS = 32;
+
+    //Applies one randomly chosen map of the fern's iterated function system to one lane
+    void advanceFernPoint(FernKernels::Orbits& orbits, int lane)
+    {
+        std::uint32_t random = Random::nextState(orbits.randomState[0][lane], orbits.randomState[1][lane],
+            orbits.randomState[2][lane], orbits.randomState[3][lane]);
+        float randomPercentage = static_cast<float>(random >> 8) * UNIT_SCALE;
+        int map = (randomPercentage >= PROBABILITY_THRESHOLDS[0]) +
+            (randomPercentage >= PROBABILITY_THRESHOLDS[1]) +
+            (randomPercentage >= PROBABILITY_THRESHOLDS[2]);
+
+        float& currentX = orbits.x[lane];
+        float& currentY = orbits.y[lane];
+        currentX = MAP_A[map] * currentX + MAP_B[map] * currentY + MAP_E[map];
+        currentY = MAP_C[map] * currentX + MAP_D[map] * currentY + MAP_F[map];
+    }
+
+    //Also finishes the partial round of lanes the SIMD kernels leave at the end of a call
+    void generateScalar(FernKernels::Orbits& orbits, glm::vec3* out, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            int lane = static_cast<int>(i % LANES);
+            advanceFernPoint(orbits, lane);
+            out[i] = glm::vec3(orbits.x[lane] + OFFSET_X, orbits.y[lane] + OFFSET_Y, 1.0f);
+        }
+    }
+
+#ifdef FERN_X86_KERNELS
+    __attribute__((target("avx2")))
+    void generateAvx2(FernKernels::Orbits& orbits, glm::vec3* out, std::size_t count)
+    {
+        //Two vectors of eight cover the sixteen lanes
+        const int WIDTH = 8;
+        const int HALVES = LANES / WIDTH;
+
+        //Map coefficients live in the low four entries of each table and are picked per lane by permute
+        const __m256 tableA = _mm256_setr_ps(MAP_A[0], MAP_A[1], MAP_A[2], MAP_A[3], 0, 0, 0, 0);
+        const __m256 tableB = _mm256_setr_ps(MAP_B[0], MAP_B[1], MAP_B[2], MAP_B[3], 0, 0, 0, 0);
+        const __m256 tableC = _mm256_setr_ps(MAP_C[0], MAP_C[1], MAP_C[2], MAP_C[3], 0, 0, 0, 0);
+        const __m256 tableD = _mm256_setr_ps(MAP_D[0], MAP_D[1], MAP_D[2], MAP_D[3], 0, 0, 0, 0);
+        const __m256 tableE = _mm256_setr_ps(MAP_E[0], MAP_E[1], MAP_E[2], MAP_E[3], 0, 0, 0, 0);
+        const __m256 tableF = _mm256_setr_ps(MAP_F[0], MAP_F[1], MAP_F[2], MAP_F[3], 0, 0, 0, 0);
+        const __m256 threshold0 = _mm256_set1_ps(PROBABILITY_THRESHOLDS[0]);
+        const __m256 threshold1 = _mm256_set1_ps(PROBABILITY_THRESHOLDS[1]);
+        const __m256 threshold2 = _mm256_set1_ps(PROBABILITY_THRESHOLDS[2]);
+        const __m256 unitScale = _mm256_set1_ps(UNIT_SCALE);
+        const __m256 offsetX = _mm256_set1_ps(OFFSET_X);
+        const __m256 offsetY = _mm256_set1_ps(OFFSET_Y);
+
+        __m256i s0[HALVES], s1[HALVES], s2[HALVES], s3[HALVES];
+        __m256 currentX[HALVES], currentY[HALVES];
+        for (int half = 0; half < HALVES; half++)
+        {
+            s0[half] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(orbits.randomState[0] + half * WIDTH));
+            s1[half] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(orbits.randomState[1] + half * WIDTH));
+            s2[half] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(orbits.randomState[2] + half * WIDTH));
+            s3[half] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(orbits.randomState[3] + half * WIDTH));
+            currentX[half] = _mm256_loadu_ps(orbits.x + half * WIDTH);
+            currentY[half] = _mm256_loadu_ps(orbits.y + half * WIDTH);
+        }
+
+        alignas(32) float pointX[WIDTH];
+        alignas(32) float pointY[WIDTH];
+        std::size_t rounds = count / LANES;
+        for (std::size_t round = 0; round < rounds; round++)
+        {
+            for (int half = 0; half < HALVES; half++)
+            {
+                //xoshiro128+ in every lane
+                __m256i random = _mm256_add_epi32(s0[half], s3[half]);
+                __m256i t = _mm256_slli_epi32(s1[half], 9);
+                s2[half] = _mm256_xor_si256(s2[half], s0[half]);
+                s3[half] = _mm256_xor_si256(s3[half], s1[half]);
+                s1[half] = _mm256_xor_si256(s1[half], s2[half]);
+                s0[half] = _mm256_xor_si256(s0[half], s3[half]);
+                s2[half] = _mm256_xor_si256(s2[half], t);
+                s3[half] = _mm256_or_si256(_mm256_slli_epi32(s3[half], 11), _mm256_srli_epi32(s3[half], 21));
+                __m256 randomPercentage = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(random, 8)), unitScale);
+
+                //Map index = number of thresholds at or below the random value (compare masks are -1)
+                __m256i map = _mm256_sub_epi32(_mm256_setzero_si256(), _mm256_add_epi32(
+                    _mm256_castps_si256(_mm256_cmp_ps(randomPercentage, threshold0, _CMP_GE_OQ)),
+                    _mm256_add_epi32(
+                        _mm256_castps_si256(_mm256_cmp_ps(randomPercentage, threshold1, _CMP_GE_OQ)),
+                        _mm256_castps_si256(_mm256_cmp_ps(randomPercentage, threshold2, _CMP_GE_OQ)))));
+
+                __m256 a = _mm256_permutevar8x32_ps(tableA, map);
+                __m256 b = _mm256_permutevar8x32_ps(tableB, map);
+                __m256 c = _mm256_permutevar8x32_ps(tableC, map);
+                __m256 d = _mm256_permutevar8x32_ps(tableD, map);
+                __m256 e = _mm256_permutevar8x32_ps(tableE, map);
+                __m256 f = _mm256_permutevar8x32_ps(tableF, map);
+
+                currentX[half] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a, currentX[half]),
+                    _mm256_mul_ps(b, currentY[half])), e);
+                currentY[half] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(c, currentX[half]),
+                    _mm256_mul_ps(d, currentY[half])), f);
+
+                _mm256_store_ps(pointX, _mm256_add_ps(currentX[half], offsetX));
+                _mm256_store_ps(pointY, _mm256_add_ps(currentY[half], offsetY));
+                glm::vec3* destination = out + round * LANES + half * WIDTH;
+                for (int lane = 0; lane < WIDTH; lane++)
+                {
+                    destination[lane] = glm::vec3(pointX[lane], pointY[lane], 1.0f);
+                }
+            }
+        }
+
+        for (int half = 0; half < HALVES; half++)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(orbits.randomState[0] + half * WIDTH), s0[half]);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(orbits.randomState[1] + half * WIDTH), s1[half]);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(orbits.randomState[2] + half * WIDTH), s2[half]);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(orbits.randomState[3] + half * WIDTH), s3[half]);
+            _mm256_storeu_ps(orbits.x + half * WIDTH, currentX[half]);
+            _mm256_storeu_ps(orbits.y + half * WIDTH, currentY[half]);
+        }
+
+        std::size_t done = rounds * LANES;
+        if (done < count)
+        {
+            generateScalar(orbits, out + done, count - done);
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    void generateAvx512(FernKernels::Orbits& orbits, glm::vec3* out, std::size_t count)
+    {
+        const __m512 tableA = _mm512_setr_ps(MAP_A[0], MAP_A[1], MAP_A[2], MAP_A[3], 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m512 tableB = _mm512_setr_ps(MAP_B[0], MAP_B[1], MAP_B[2], MAP_B[3], 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m512 tableC = _mm512_setr_ps(MAP_C[0], MAP_C[1], MAP_C[2], MAP_C[3], 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m512 tableD = _mm512_setr_ps(MAP_D[0], MAP_D[1], MAP_D[2], MAP_D[3], 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m512 tableE = _mm512_setr_ps(MAP_E[0], MAP_E[1], MAP_E[2], MAP_E[3], 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m512 tableF = _mm512_setr_ps(MAP_F[0], MAP_F[1], MAP_F[2], MAP_F[3], 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m512 threshold0 = _mm512_set1_ps(PROBABILITY_THRESHOLDS[0]);
+        const __m512 threshold1 = _mm512_set1_ps(PROBABILITY_THRESHOLDS[1]);
+        const __m512 threshold2 = _mm512_set1_ps(PROBABILITY_THRESHOLDS[2]);
+        const __m512 unitScale = _mm512_set1_ps(UNIT_SCALE);
+        const __m512 offsetX = _mm512_set1_ps(OFFSET_X);
+        const __m512 offsetY = _mm512_set1_ps(OFFSET_Y);
+        const __m512i one = _mm512_set1_epi32(1);
+
+        __m512i s0 = _mm512_loadu_si512(orbits.randomState[0]);
+        __m512i s1 = _mm512_loadu_si512(orbits.randomState[1]);
+        __m512i s2 = _mm512_loadu_si512(orbits.randomState[2]);
+        __m512i s3 = _mm512_loadu_si512(orbits.randomState[3]);
+        __m512 currentX = _mm512_loadu_ps(orbits.x);
+        __m512 currentY = _mm512_loadu_ps(orbits.y);
+
+        alignas(64) float pointX[LANES];
+        alignas(64) float pointY[LANES];
+        std::size_t rounds = count / LANES;
+        for (std::size_t round = 0; round < rounds; round++)
+        {
+            __m512i random = _mm512_add_epi32(s0, s3);
+            __m512i t = _mm512_slli_epi32(s1, 9);
+            s2 = _mm512_xor_si512(s2, s0);
+            s3 = _mm512_xor_si512(s3, s1);
+            s1 = _mm512_xor_si512(s1, s2);
+            s0 = _mm512_xor_si512(s0, s3);
+            s2 = _mm512_xor_si512(s2, t);
+            s3 = _mm512_rol_epi32(s3, 11);
+            __m512 randomPercentage = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_srli_epi32(random, 8)), unitScale);
+
+            __m512i map = _mm512_setzero_si512();
+            map = _mm512_mask_add_epi32(map, _mm512_cmp_ps_mask(randomPercentage, threshold0, _CMP_GE_OQ), map, one);
+            map = _mm512_mask_add_epi32(map, _mm512_cmp_ps_mask(randomPercentage, threshold1, _CMP_GE_OQ), map, one);
+            map = _mm512_mask_add_epi32(map, _mm512_cmp_ps_mask(randomPercentage, threshold2, _CMP_GE_OQ), map, one);
+
+            __m512 a = _mm512_permutexvar_ps(map, tableA);
+            __m512 b = _mm512_permutexvar_ps(map, tableB);
+            __m512 c = _mm512_permutexvar_ps(map, tableC);
+            __m512 d = _mm512_permutexvar_ps(map, tableD);
+            __m512 e = _mm512_permutexvar_ps(map, tableE);
+            __m512 f = _mm512_permutexvar_ps(map, tableF);
+
+            currentX = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(a, currentX), _mm512_mul_ps(b, currentY)), e);
+            currentY = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(c, currentX), _mm512_mul_ps(d, currentY)), f);
+
+            _mm512_store_ps(pointX, _mm512_add_ps(currentX, offsetX));
+            _mm512_store_ps(pointY, _mm512_add_ps(currentY, offsetY));
+            glm::vec3* destination = out + round * LANES;
+            for (int lane = 0; lane < LANES; lane++)
+            {
+                destination[lane] = glm::vec3(pointX[lane], pointY[lane], 1.0f);
+            }
+        }
+
+        _mm512_storeu_si512(orbits.randomState[0], s0);
+        _mm512_storeu_si512(orbits.randomState[1], s1);
+        _mm512_storeu_si512(orbits.randomState[2], s2);
+        _mm512_storeu_si512(orbits.randomState[3], s3);
+        _mm512_storeu_ps(orbits.x, currentX);
+        _mm512_storeu_ps(orbits.y, currentY);
+
+        std::size_t done = rounds * LANES;
+        if (done < count)
+        {
+            generateScalar(orbits, out + done, count - done);
+        }
+    }
+#endif
+}
+
+bool FernKernels::isSupported(Backend backend)
+{
+#ifdef FERN_X86_KERNELS
+    //Needed when this runs from a static initializer, before the runtime has probed the CPU
+    __builtin_cpu_init();
+#endif
+
+    switch (backend)
+    {
+#ifdef FERN_X86_KERNELS
+    case AVX2_BACKEND:
+        return __builtin_cpu_supports("avx2");
+    case AVX512_BACKEND:
+        return __builtin_cpu_supports("avx512f");
+#endif
+    case SCALAR_BACKEND:
+        return true;
+    default:
+        return false;
+    }
+}
+
+FernKernels::Backend FernKernels::getBestBackend()
+{
+    if (isSupported(AVX512_BACKEND)) return AVX512_BACKEND;
+    if (isSupported(AVX2_BACKEND)) return AVX2_BACKEND;
+    return SCALAR_BACKEND;
+}
+
+const char* FernKernels::getBackendName(Backend backend)
+{
+    switch (backend)
+    {
+    case AVX2_BACKEND:
+        return "avx2";
+    case AVX512_BACKEND:
+        return "avx512";
+    case SCALAR_BACKEND:
+    default:
+        return "scalar";
+    }
+}
+
+bool FernKernels::getBackendByName(const char* name, Backend& backend)
+{
+    for (Backend candidate : BACKENDS)
+    {
+        if (std::strcmp(name, getBackendName(candidate)) == 0)
+        {
+            backend = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void FernKernels::initOrbits(Orbits& orbits, std::uint64_t seed, std::uint64_t streamIndex)
+{
+    for (int lane = 0; lane < LANES; lane++)
+    {
+        std::uint32_t state[4];
+        Random::seedState(seed, streamIndex * LANES + lane, state);
+        for (int word = 0; word < 4; word++)
+        {
+            orbits.randomState[word][lane] = state[word];
+        }
+
+        orbits.x[lane] = static_cast<float>(lane) / LANES;
+        orbits.y[lane] = 1.0f - static_cast<float>(lane) / LANES;
+        for (int step = 0; step < WARM_UP_STEPS; step++)
+        {
+            advanceFernPoint(orbits, lane);
+        }
+    }
+}
+
+void FernKernels::generate(Backend backend, Orbits& orbits, glm::vec3* out, std::size_t count)
+{
+    if (!isSupported(backend))
+    {
+        backend = SCALAR_BACKEND;
+    }
+
+    switch (backend)
+    {
+#ifdef FERN_X86_KERNELS
+    case AVX2_BACKEND:
+        generateAvx2(orbits, out, count);
+        break;
+    case AVX512_BACKEND:
+        generateAvx512(orbits, out, count);
+        break;
+#endif
+    default:
+        generateScalar(orbits, out, count);
+        break;
+    }
+}
@@ -0,0 +1,60 @@
+/*
+ * FernKernels.h
+ *	Interchangeable kernels that run the Barnsley fern chaos game.
+ *	The SIMD kernels advance one independent orbit per vector lane.
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef FERNKERNELS_H_
+#define FERNKERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace FernKernels
+{
+    enum Backend
+    {
+        SCALAR_BACKEND,
+        AVX2_BACKEND,
+        AVX512_BACKEND
+    };
+
+    //Whether the running CPU (and this build) can execute the given backend
+    bool isSupported(Backend backend);
+
+    //The widest backend supported on this machine
+    Backend getBestBackend();
+
+    const char* getBackendName(Backend backend);
+
+    //The backend getBackendName gives `name` for. Returns false if there is none.
+    bool getBackendByName(const char* name, Backend& backend);
+
+    const Backend BACKENDS[] = { SCALAR_BACKEND, AVX2_BACKEND, AVX512_BACKEND };
+    const int BACKEND_COUNT = sizeof(BACKENDS) / sizeof(BACKENDS[0]);
+
+    //Resumable state of MAX_LANES independent orbits, so a stream can be continued across calls
+    struct Orbits
+    {
+        static const int MAX_LANES = 16;
+
+        //xoshiro128+ state of every lane, word-major so a kernel loads one vector per word
+        std::uint32_t randomState[4][MAX_LANES];
+        float x[MAX_LANES];
+        float y[MAX_LANES];
+    };
+
+    //Seeds the orbits of one stream from Random streams (streamIndex * MAX_LANES + lane) of `seed`
+    //and runs them onto the attractor. Callers running several streams at once must give each
+    //a different `streamIndex`.
+    void initOrbits(Orbits& orbits, std::uint64_t seed, std::uint64_t streamIndex);
+
+    //Advances the orbits and writes the next `count` fern points to `out`. Point i of a call
+    //comes from lane i % MAX_LANES whichever backend runs, so all backends write the same points.
+    void generate(Backend backend, Orbits& orbits, glm::vec3* out, std::size_t count);
+}
+
+#endif /* FERNKERNELS_H_ */
@@ -0,0 +1,35 @@
+/*
+ * FramePacer.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "FramePacer.h"
+
+const double FramePacer::BACKGROUND_FRAME_LIMIT = 10.0;
+
+FramePacer::FramePacer(double frameLimit) : frameLimit(frameLimit), background(false), shownFrame(false),
+		lastFrameTime(0.0) {
+}
+
+double FramePacer::getWaitTime(double now) const {
+	double limit = getCurrentFrameLimit();
+	if (!shownFrame || limit <= 0.0) {
+		return 0.0;
+	}
+
+	double wait = lastFrameTime + 1.0 / limit - now;
+	return (wait > 0.0) ? wait : 0.0;
+}
+
+void FramePacer::frameShown(double now) {
+	shownFrame = true;
+	lastFrameTime = now;
+}
+
+double FramePacer::getCurrentFrameLimit() const {
+	if (background && (frameLimit <= 0.0 || frameLimit > BACKGROUND_FRAME_LIMIT)) {
+		return BACKGROUND_FRAME_LIMIT;
+	}
+	return frameLimit;
+}
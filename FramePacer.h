@@ -0,0 +1,37 @@
+/*
+ * FramePacer.h
+ *	Decides when the main loop may show its next frame: no faster than the frame limit,
+ *	and much slower while the window is in the background.
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef FRAMEPACER_H_
+#define FRAMEPACER_H_
+
+class FramePacer {
+public:
+	//frameLimit is in frames per second; 0 leaves the rate to vsync
+	explicit FramePacer(double frameLimit);
+
+	void setFrameLimit(double frameLimit) { this->frameLimit = frameLimit; }
+	double getFrameLimit() const { return frameLimit; }
+
+	//Throttles to BACKGROUND_FRAME_LIMIT while the window is unfocused
+	void setBackground(bool background) { this->background = background; }
+
+	//Seconds from now until the next frame may be shown (0 if it may be shown now)
+	double getWaitTime(double now) const;
+	void frameShown(double now);
+
+	static const double BACKGROUND_FRAME_LIMIT;
+
+private:
+	double getCurrentFrameLimit() const;
+
+	double frameLimit;
+	bool background;
+	bool shownFrame;
+	double lastFrameTime;
+};
+
+#endif /* FRAMEPACER_H_ */
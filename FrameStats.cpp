@@ -0,0 +1,156 @@
+/*
+ * FrameStats.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+	const double MILLISECONDS = 1000.0;
+}
+
+FrameStats::FrameStats(std::size_t windowSize) : windowSize(windowSize), current(), frameNumber(0) {
+}
+
+void FrameStats::record(Stage stage, double seconds) {
+	current.seconds[stage] += seconds;
+}
+
+void FrameStats::recordGpu(double seconds) {
+	gpuResults.push_back(seconds);
+	if (gpuResults.size() > windowSize) {
+		gpuResults.pop_front();
+	}
+	current.seconds[GPU] = seconds;
+	current.gpuResults++;
+}
+
+void FrameStats::endFrame() {
+	frames.push_back(current);
+	if (frames.size() > windowSize) {
+		frames.pop_front();
+	}
+
+	if (log.is_open()) {
+		log << frameNumber;
+		for (int stage = 0; stage < STAGE_COUNT; stage++) {
+			log << ",";
+			if (stage != GPU || current.gpuResults) {
+				log << current.seconds[stage] * MILLISECONDS;
+			}
+		}
+		Summary frame = getSummary(FRAME);
+		Summary gpu = getSummary(GPU);
+		log << "," << frame.min * MILLISECONDS << "," << frame.average * MILLISECONDS << ","
+			<< frame.p99 * MILLISECONDS << "," << gpu.min * MILLISECONDS << "," << gpu.average * MILLISECONDS
+			<< "," << gpu.p99 * MILLISECONDS << "\n";
+	}
+
+	frameNumber++;
+	current = Frame();
+}
+
+FrameStats::Summary FrameStats::getSummary(Stage stage) const {
+	if (stage == GPU) {
+		return summarise(std::vector<double>(gpuResults.begin(), gpuResults.end()));
+	}
+
+	std::vector<double> values;
+	values.reserve(frames.size());
+	for (const Frame& frame : frames) {
+		values.push_back(frame.seconds[stage]);
+	}
+	return summarise(values);
+}
+
+FrameStats::Summary FrameStats::summarise(std::vector<double> values) {
+	Summary summary = { 0.0, 0.0, 0.0, 0.0 };
+	if (values.empty()) {
+		return summary;
+	}
+
+	double total = 0.0;
+	for (double value : values) {
+		total += value;
+	}
+	summary.min = *std::min_element(values.begin(), values.end());
+	summary.average = total / values.size();
+
+	//Nearest rank: the smallest value at least that fraction of the values is no greater than
+	size_t rank = (size_t)std::ceil(0.99 * values.size()) - 1;
+	std::nth_element(values.begin(), values.begin() + rank, values.end());
+	summary.p99 = values[rank];
+	rank = (size_t)std::ceil(0.5 * values.size()) - 1;
+	std::nth_element(values.begin(), values.begin() + rank, values.end());
+	summary.median = values[rank];
+	return summary;
+}
+
+std::string FrameStats::getOverlayText() const {
+	if (frames.empty()) {
+		return std::string();
+	}
+
+	std::ostringstream text;
+	text << std::fixed << std::setprecision(2);
+	const Frame& last = frames.back();
+	for (int stage = 0; stage < GPU; stage++) {
+		text << getStageName((Stage)stage) << " " << last.seconds[stage] * MILLISECONDS << "  ";
+	}
+	Summary frame = getSummary(FRAME);
+	text << "| frame min " << frame.min * MILLISECONDS << " avg " << frame.average * MILLISECONDS
+		<< " p99 " << frame.p99 * MILLISECONDS;
+	if (!gpuResults.empty()) {
+		Summary gpu = getSummary(GPU);
+		text << "  | gpu " << gpuResults.back() * MILLISECONDS << " avg " << gpu.average * MILLISECONDS
+			<< " p99 " << gpu.p99 * MILLISECONDS;
+	}
+	text << " ms";
+	return text.str();
+}
+
+bool FrameStats::startLog(const std::string& path) {
+	stopLog();
+	log.open(path.c_str());
+	if (!log.is_open()) {
+		return false;
+	}
+
+	log << "frame";
+	for (int stage = 0; stage < STAGE_COUNT; stage++) {
+		log << "," << getStageName((Stage)stage) << "_ms";
+	}
+	log << ",frame_min_ms,frame_avg_ms,frame_p99_ms,gpu_min_ms,gpu_avg_ms,gpu_p99_ms\n";
+	return true;
+}
+
+void FrameStats::stopLog() {
+	if (log.is_open()) {
+		log.close();
+	}
+}
+
+const char* FrameStats::getStageName(Stage stage) {
+	switch (stage) {
+	case GENERATE:
+		return "generate";
+	case UPLOAD:
+		return "upload";
+	case SUBMIT:
+		return "submit";
+	case SWAP:
+		return "swap";
+	case GPU:
+		return "gpu";
+	case FRAME:
+		return "frame";
+	default:
+		return "";
+	}
+}
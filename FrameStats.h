@@ -0,0 +1,76 @@
+/*
+ * FrameStats.h
+ *	Where the time of each frame goes: CPU seconds per stage, kept over a rolling window of
+ *	frames, and GPU seconds, kept over a window of query results, for min/avg/p99, and
+ *	optionally logged to a CSV file.
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef FRAMESTATS_H_
+#define FRAMESTATS_H_
+
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class FrameStats {
+public:
+	enum Stage {
+		GENERATE,	//Generating the level shown this frame, on the worker thread
+		UPLOAD,		//Copying it to the GPU
+		SUBMIT,		//Issuing the draw calls
+		SWAP,		//glfwSwapBuffers
+		GPU,		//GPU time of a recent frame's draws, read back a few frames late and kept per result
+		FRAME,		//Main thread time of the frame: upload, submit and swap
+		STAGE_COUNT
+	};
+
+	struct Summary {
+		double min;
+		double average;
+		double median;
+		double p99;
+	};
+
+	explicit FrameStats(std::size_t windowSize);
+
+	//Adds seconds to a CPU stage of the frame being recorded
+	void record(Stage stage, double seconds);
+	//Adds one GPU time. Results arrive late and not always one per frame, so they are kept in
+	//their own window rather than in the frame they arrive in.
+	void recordGpu(double seconds);
+	//Moves the frame being recorded into the window (and the log) and starts the next one
+	void endFrame();
+
+	//Over the frames in the window, or the GPU results in theirs, in seconds
+	Summary getSummary(Stage stage) const;
+	//Of any set of values (all zero if there are none)
+	static Summary summarise(std::vector<double> values);
+	//Latest frame and window averages, in milliseconds, short enough for a title bar
+	std::string getOverlayText() const;
+
+	//Writes one line per frame from now on: each stage in milliseconds (gpu is the last result
+	//taken that frame, blank if none was), then min/avg/p99 of the frame and GPU windows
+	bool startLog(const std::string& path);
+	void stopLog();
+	bool isLogging() const { return log.is_open(); }
+
+	static const char* getStageName(Stage stage);
+
+private:
+	struct Frame {
+		double seconds[STAGE_COUNT];
+		int gpuResults;
+	};
+
+	std::size_t windowSize;
+	std::deque<Frame> frames;
+	std::deque<double> gpuResults;
+	Frame current;
+	unsigned long frameNumber;
+	std::ofstream log;
+};
+
+#endif /* FRAMESTATS_H_ */
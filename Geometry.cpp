@@ -7,7 +7,8 @@
 
 #include "Geometry.h"
 
-Geometry::Geometry() : vao(0), vertexBuffer(0), normalBuffer(0), uvBuffer(0), colorBuffer(0) {
+Geometry::Geometry() : vao(0), vertexBuffer(0), normalBuffer(0), uvBuffer(0), colorBuffer(0), bufferCapacity(0),
+		instanceBuffer(0), instanceCount(0), layout(VertexLayouts::FULL) {
 	//vectors are initially empty
 	//Pointers are initially null
 	//Call RenderingEngine::assignBuffers and RenderingEngine::setBufferData to fully initialize the geometry
@@ -18,3 +19,25 @@ Geometry::~Geometry() {
 
 }
 
+size_t Geometry::getCpuByteSize() const {
+	return verts.capacity() * sizeof(glm::vec3) + normals.capacity() * sizeof(glm::vec3) +
+		colors.capacity() * sizeof(glm::vec3) + uvs.capacity() * sizeof(glm::vec2) +
+		firstVertices.capacity() * sizeof(GLint) + vertexCounts.capacity() * sizeof(GLsizei) +
+		instanceTransforms.capacity() * sizeof(glm::mat3) + instanceColourOffsets.capacity() * sizeof(glm::vec3) +
+		sharedVertices.capacity() * sizeof(SharedVertices);
+}
+
+void Geometry::addSharedVertices(const std::shared_ptr<const void>& owner, const glm::vec3* verts,
+	const glm::vec3* colors, size_t count) {
+	SharedVertices shared = { owner, verts, colors, count };
+	sharedVertices.push_back(shared);
+}
+
+size_t Geometry::getVertexCount() const {
+	size_t count = verts.size();
+	for (const SharedVertices& shared : sharedVertices) {
+		count += shared.count;
+	}
+	return count;
+}
+
@@ -8,6 +8,8 @@
 #ifndef GEOMETRY_H_
 #define GEOMETRY_H_
 
+#include <algorithm>
+#include <memory>
 #include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -16,17 +18,41 @@
 //**Must include glad and GLFW in this order or it breaks**
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+
+#include "VertexLayout.h"
 
 class Geometry {
 public:
 	Geometry();
 	virtual ~Geometry();
+
+	//Bytes the vectors below have allocated (not counting the shared vertices themselves)
+	size_t getCpuByteSize() const;
 
 	//Data structures for storing vertices, normals colors and uvs
 	std::vector<glm::vec3> verts;
 	std::vector<glm::vec3> normals;
 	std::vector<glm::vec3> colors;
 	std::vector<glm::vec2> uvs;
+
+	//Vertices held by something else, such as a cached level, drawn after verts. The owner keeps
+	//them alive, so they are drawn from where they are rather than copied.
+	struct SharedVertices {
+		std::shared_ptr<const void> owner;
+		const glm::vec3* verts;
+		const glm::vec3* colors;
+		size_t count;
+	};
+	std::vector<SharedVertices> sharedVertices;
+	void addSharedVertices(const std::shared_ptr<const void>& owner, const glm::vec3* verts, const glm::vec3* colors,
+		size_t count);
+
+	//Vertices drawn: verts, then each shared run
+	size_t getVertexCount() const;
+	//Calls visit(verts, colors, count, index) for each stored run of the vertices [first, first + count),
+	//index counting from first. colors is null for a run without a colour per vertex.
+	template <typename Visit>
+	void forEachVertexRun(size_t first, size_t count, Visit visit) const;
 
 	//Pointers to the vao and vbos associated with the geometry
 	GLuint vao;
@@ -35,8 +61,48 @@ public:
 	GLuint uvBuffer;
 	GLuint colorBuffer;
 
+	//Number of vertices the vbos currently have room for
+	size_t bufferCapacity;
+
+	//Per-instance transforms and colour offsets, and how many copies to draw
+	//(0 draws the geometry once, uninstanced)
+	GLuint instanceBuffer;
+	GLsizei instanceCount;
+	//CPU copies of the instance data, for the software rasterizer
+	std::vector<glm::mat3> instanceTransforms;
+	std::vector<glm::vec3> instanceColourOffsets;
+
 	//Draw mode for how OpenGL interprets primitives
 	GLuint drawMode;
+
+	//How verts and colors are packed into the vbos (set before setBufferData)
+	VertexLayout layout;
+
+	//Ranges of verts drawn as separate primitives when several objects share the vbos,
+	//submitted together in one multi-draw (empty draws all of verts as one primitive)
+	std::vector<GLint> firstVertices;
+	std::vector<GLsizei> vertexCounts;
 };
 
+template <typename Visit>
+void Geometry::forEachVertexRun(size_t first, size_t count, Visit visit) const {
+	size_t runStart = 0;
+	size_t done = 0;
+	auto visitRun = [&](const glm::vec3* runVerts, const glm::vec3* runColors, size_t runCount) {
+		size_t position = first + done;
+		if (done < count && position < runStart + runCount) {
+			size_t offset = position - runStart;
+			size_t visited = std::min(runCount - offset, count - done);
+			visit(runVerts + offset, runColors ? runColors + offset : 0, visited, done);
+			done += visited;
+		}
+		runStart += runCount;
+	};
+
+	visitRun(verts.data(), colors.size() >= verts.size() ? colors.data() : 0, verts.size());
+	for (size_t i = 0; i < sharedVertices.size() && done < count; i++) {
+		visitRun(sharedVertices[i].verts, sharedVertices[i].colors, sharedVertices[i].count);
+	}
+}
+
 #endif /* GEOMETRY_H_ */
@@ -0,0 +1,953 @@
+/*
+ * GeometryBuilder.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "GeometryBuilder.h"
+
+#include "FernKernels.h"
+#include "Profiler.h"
+#include "ThreadTools.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    const glm::vec3 TEAL_COLOUR(0.25f, 0.75f, 0.75f);
+    const glm::vec3 GOLD_COLOUR(0.7f, 0.7f, 0.5f);
+    const glm::vec3 BLUE_COLOUR(0.25f, 0.0f, 0.75f);
+    const glm::vec3 RED_COLOUR(0.5f, 0.25f, 0.1f);
+
+    glm::vec3 getMidpoint(const glm::vec3& firstPoint, const glm::vec3& secondPoint)
+    {
+        float x1 = firstPoint[0];
+        float y1 = firstPoint[1];
+
+        float x2 = secondPoint[0];
+        float y2 = secondPoint[1];
+
+        return glm::vec3((x1+x2)/2.0f,(y1+y2)/2.0f, 1.0f);
+    }
+
+    void drawSquareFinishingAtStartingPointForNextIteration(
+        const std::vector<glm::vec3>& pointsForIteration,
+        const glm::vec3& colourForIteration, GeometryData& currentGeometry)
+    {
+        for(glm::vec3 point: pointsForIteration)
+        {
+            currentGeometry.verts.push_back(point);
+            currentGeometry.colors.push_back(colourForIteration);
+        }
+
+        currentGeometry.verts.push_back(pointsForIteration[0]);
+        currentGeometry.colors.push_back(colourForIteration);
+
+        glm::vec3 startingPointForNextIteration = getMidpoint(pointsForIteration[0], pointsForIteration[1]);
+        currentGeometry.verts.push_back(startingPointForNextIteration);
+        currentGeometry.colors.push_back(colourForIteration);
+    }
+
+    std::vector<glm::vec3> getPointsForNextIteration(const std::vector<glm::vec3>& pointsForIteration)
+    {
+        std::vector<glm::vec3> midpoints;
+        for (int i = 0; i < 3; i++)
+        {
+            midpoints.push_back(getMidpoint(pointsForIteration[i], pointsForIteration[i+1]));
+        }
+        midpoints.push_back(getMidpoint(pointsForIteration[3], pointsForIteration[0]));
+        return midpoints;
+    }
+
+    const std::size_t FERN_POINTS_PER_ITERATION = 1000000;
+    const std::size_t RANDOM_SIERPINSKI_POINTS_PER_ITERATION = 250;
+
+    //Every fern level is split into this many stripes, each with its own random stream
+    const std::size_t FERN_STRIPES_PER_ITERATION = 64;
+    const std::size_t FERN_POINTS_PER_STRIPE = FERN_POINTS_PER_ITERATION / FERN_STRIPES_PER_ITERATION;
+
+    //Below this many triangles a gasket slice is not worth a thread of its own
+    const std::size_t SIERPINSKI_MINIMUM_SLICE = 4096;
+
+    //Deepest gasket level stored as vertices when the gasket is drawn instanced (243 triangles)
+    const int INSTANCED_SIERPINSKI_BASE_DEPTH = 5;
+
+    //Highest Hilbert level stored as vertices when the curve is drawn instanced (1024 vertices)
+    const int INSTANCED_HILBERT_BASE_LEVEL = 5;
+
+    //Below this many points a Hilbert slice is not worth a thread of its own
+    const std::size_t HILBERT_MINIMUM_SLICE = 16384;
+
+    //Below this many vertices a slice of a copy is not worth a thread of its own
+    const std::size_t COPY_MINIMUM_SLICE = 65536;
+
+    //Below this many vertices a spiral slice is not worth a thread of its own
+    const std::size_t SPIRAL_MINIMUM_SLICE = 16384;
+
+    //Largest gap, in pixels, allowed between the spiral and its segments
+    const double SPIRAL_TOLERANCE_PIXELS = 0.25;
+    //Fewest segments drawn for a turn of the spiral, however small it is on screen
+    const std::size_t SPIRAL_MINIMUM_SEGMENTS_PER_TURN = 8;
+    //Screen scale the two-argument buildSpiral assumes: the default 512 pixel window over [-1, 1]
+    const float DEFAULT_PIXELS_PER_UNIT = 256.0f;
+
+    //Points generated between histogram updates in the density builders
+    const std::size_t DENSITY_CHUNK_SIZE = 4096;
+
+    FernKernels::Backend fernBackend = FernKernels::getBestBackend();
+
+    //Writes fern levels [firstLevel, firstLevel + levelCount) to out. Stripes are shared out
+    //between the workers, and each writes into its own slice of the output.
+    void generateFernLevels(std::uint64_t seed, int firstLevel, int levelCount, glm::vec3* out)
+    {
+        std::size_t firstStripe = static_cast<std::size_t>(firstLevel) * FERN_STRIPES_PER_ITERATION;
+        std::size_t stripeCount = static_cast<std::size_t>(levelCount) * FERN_STRIPES_PER_ITERATION;
+        FernKernels::Backend backend = fernBackend;
+        ThreadTools::parallelFor(stripeCount, 1,
+            [out, seed, firstStripe, backend](std::size_t begin, std::size_t end, unsigned int workerIndex)
+        {
+            for (std::size_t stripe = begin; stripe < end && !ThreadTools::isCancelled(); stripe++)
+            {
+                FernKernels::Orbits orbits;
+                FernKernels::initOrbits(orbits, seed, firstStripe + stripe);
+                FernKernels::generate(backend, orbits, out + stripe * FERN_POINTS_PER_STRIPE, FERN_POINTS_PER_STRIPE);
+            }
+        });
+    }
+
+    //Same stripes as generateFernLevels, but each worker bins its points into its own grid
+    //through a small scratch buffer, and the grids are merged into `histogram` at the end
+    void binFernLevels(std::uint64_t seed, int firstLevel, int levelCount, DensityHistogram& histogram)
+    {
+        std::size_t firstStripe = static_cast<std::size_t>(firstLevel) * FERN_STRIPES_PER_ITERATION;
+        std::size_t stripeCount = static_cast<std::size_t>(levelCount) * FERN_STRIPES_PER_ITERATION;
+        DensityHistogram emptyHistogram(histogram);
+        emptyHistogram.clear();
+        std::vector<DensityHistogram> workerHistograms(ThreadTools::getWorkerCount(), emptyHistogram);
+        FernKernels::Backend backend = fernBackend;
+        ThreadTools::parallelFor(stripeCount, 1,
+            [&workerHistograms, seed, firstStripe, backend](std::size_t begin, std::size_t end, unsigned int workerIndex)
+        {
+            std::vector<glm::vec3> chunk(std::min(FERN_POINTS_PER_STRIPE, DENSITY_CHUNK_SIZE));
+            for (std::size_t stripe = begin; stripe < end && !ThreadTools::isCancelled(); stripe++)
+            {
+                FernKernels::Orbits orbits;
+                FernKernels::initOrbits(orbits, seed, firstStripe + stripe);
+                for (std::size_t done = 0; done < FERN_POINTS_PER_STRIPE; done += chunk.size())
+                {
+                    std::size_t count = std::min(chunk.size(), FERN_POINTS_PER_STRIPE - done);
+                    FernKernels::generate(backend, orbits, chunk.data(), count);
+                    workerHistograms[workerIndex].addPoints(chunk.data(), count);
+                }
+            }
+        });
+
+        for (const DensityHistogram& workerHistogram : workerHistograms)
+        {
+            histogram.merge(workerHistogram);
+        }
+    }
+
+    void getOuterTriangle(glm::vec3 outerTriangle[3])
+    {
+        outerTriangle[0] = glm::vec3(-0.9f, -0.9f, 1.0f);
+        outerTriangle[1] = glm::vec3(0.9f, -0.9f, 1.0f);
+        outerTriangle[2] = glm::vec3(0.0f, static_cast<float>(sqrt(1.8*1.8-0.9*0.9)/2.0), 1.0f);
+    }
+
+    std::size_t powerOfThree(int exponent)
+    {
+        std::size_t power = 1;
+        for (int i = 0; i < exponent; i++)
+        {
+            power *= 3;
+        }
+        return power;
+    }
+
+    //Where gasket triangle `address` of the given depth sits: the sum over depths k of
+    //(corner picked by digit k) / 2^k, with the most significant digit at depth 1
+    void getGasketOffset(std::size_t address, int depth, const glm::vec3 outerTriangle[3],
+        float& offsetX, float& offsetY)
+    {
+        offsetX = 0.0f;
+        offsetY = 0.0f;
+        float weight = std::ldexp(1.0f, -depth);
+        for (int k = 0; k < depth; k++)
+        {
+            const glm::vec3& corner = outerTriangle[address % 3];
+            offsetX += corner[0] * weight;
+            offsetY += corner[1] * weight;
+            address /= 3;
+            weight *= 2.0f;
+        }
+    }
+
+    //Writes the 3^depth triangles of a gasket level, in parallel. Every three triangles lower
+    //red, green and blue in turn by colourStep (as the old breadth-first version did).
+    void writeGasketTriangles(int depth, float colourStep, glm::vec3* verts, glm::vec3* colors)
+    {
+        glm::vec3 outerTriangle[3];
+        getOuterTriangle(outerTriangle);
+
+        std::size_t triangleCount = powerOfThree(depth);
+        ThreadTools::parallelFor(triangleCount, SIERPINSKI_MINIMUM_SLICE,
+            [verts, colors, depth, colourStep, &outerTriangle](std::size_t begin, std::size_t end, unsigned int workerIndex)
+        {
+            //vertex = outer vertex / 2^depth + offset of the triangle's address
+            float scale = std::ldexp(1.0f, -depth);
+            for (std::size_t triangle = begin; triangle < end; triangle++)
+            {
+                float offsetX;
+                float offsetY;
+                getGasketOffset(triangle, depth, outerTriangle, offsetX, offsetY);
+
+                glm::vec3 colour(1.0f - static_cast<float>(triangle / 3 + 1) * colourStep,
+                                 1.0f - static_cast<float>((triangle + 2) / 3) * colourStep,
+                                 1.0f - static_cast<float>((triangle + 1) / 3) * colourStep);
+                for (int vertex = 0; vertex < 3; vertex++)
+                {
+                    verts[3 * triangle + vertex] = glm::vec3(outerTriangle[vertex][0] * scale + offsetX,
+                                                             outerTriangle[vertex][1] * scale + offsetY, 1.0f);
+                    colors[3 * triangle + vertex] = colour;
+                }
+            }
+        });
+    }
+
+    //Segments a turn needs for its chords to stay within SPIRAL_TOLERANCE_PIXELS of a circle
+    //of the given radius: a chord spanning angle a sags r * (1 - cos(a / 2)) below the arc.
+    //Using the turn's outer radius keeps the whole turn within tolerance.
+    std::size_t getSpiralSegmentsPerTurn(double radiusInPixels)
+    {
+        if (radiusInPixels <= SPIRAL_TOLERANCE_PIXELS)
+        {
+            return SPIRAL_MINIMUM_SEGMENTS_PER_TURN;
+        }
+        double segmentAngle = 2.0 * std::acos(1.0 - SPIRAL_TOLERANCE_PIXELS / radiusInPixels);
+        std::size_t segments = static_cast<std::size_t>(std::ceil(2.0 * M_PI / segmentAngle));
+        return std::max(segments, SPIRAL_MINIMUM_SEGMENTS_PER_TURN);
+    }
+
+    glm::vec3 getSpiralColour(float t)
+    {
+        return glm::vec3(BLUE_COLOUR[0] + (RED_COLOUR[0] - BLUE_COLOUR[0])*t,
+                         BLUE_COLOUR[1] + (RED_COLOUR[1] - BLUE_COLOUR[1])*t,
+                         BLUE_COLOUR[2] + (RED_COLOUR[2] - BLUE_COLOUR[2])*t);
+    }
+
+    //destination[i] = linear * source[i] + offset for count vertices, in parallel slices.
+    //source and destination may be the same array, but must not otherwise overlap.
+    void transformCopy(const glm::mat3& linear, const glm::vec3& offset,
+        const glm::vec3* source, glm::vec3* destination, std::size_t count)
+    {
+        ThreadTools::parallelFor(count, COPY_MINIMUM_SLICE,
+            [&linear, &offset, source, destination](std::size_t begin, std::size_t end, unsigned int workerIndex)
+        {
+            //Plain loop over the flat floats, which the compiler vectorizes
+            const float* in = &source[0][0];
+            float* out = &destination[0][0];
+            for (std::size_t i = begin; i < end; i++)
+            {
+                float x = in[3 * i];
+                float y = in[3 * i + 1];
+                float z = in[3 * i + 2];
+                out[3 * i] = linear[0][0] * x + linear[1][0] * y + linear[2][0] * z + offset[0];
+                out[3 * i + 1] = linear[0][1] * x + linear[1][1] * y + linear[2][1] * z + offset[1];
+                out[3 * i + 2] = linear[0][2] * x + linear[1][2] * y + linear[2][2] * z + offset[2];
+            }
+        });
+    }
+
+    //Continues the random Sierpinski walk from currentPoint, writing count points to out
+    void advanceRandomSierpinski(glm::vec3& currentPoint, const glm::vec3 outerTriangle[3],
+        Random::Stream& random, glm::vec3* out, std::size_t count)
+    {
+        for(std::size_t i = 0; i < count; i++)
+        {
+            currentPoint = getMidpoint(currentPoint, outerTriangle[random.nextBelow(3)]);
+            out[i] = currentPoint;
+        }
+    }
+
+    std::vector<glm::vec3> drawSingleSquareWithNestedDiamond(
+        const std::vector<glm::vec3>& outerSquareVertices, std::vector<GeometryData>& objects)
+    {
+        GeometryData nestedSquares;
+        nestedSquares.primitive = LINE_STRIP_PRIMITIVE;
+        drawSquareFinishingAtStartingPointForNextIteration(outerSquareVertices, TEAL_COLOUR,
+            nestedSquares);
+        std::vector<glm::vec3> innerDiamondVertices = getPointsForNextIteration(outerSquareVertices);
+        drawSquareFinishingAtStartingPointForNextIteration(innerDiamondVertices,
+            GOLD_COLOUR, nestedSquares);
+        objects.push_back(nestedSquares);
+        return getPointsForNextIteration(innerDiamondVertices);
+    }
+
+    //The four Hilbert sub-curve orientations: A starts upwards, B rightwards, C downwards and D leftwards
+    enum HilbertType { HILBERT_A, HILBERT_B, HILBERT_C, HILBERT_D };
+
+    //Sub-curves and joining moves each orientation is made of
+    const HilbertType HILBERT_CHILDREN[4][4] = {
+        {HILBERT_B, HILBERT_A, HILBERT_A, HILBERT_C},
+        {HILBERT_A, HILBERT_B, HILBERT_B, HILBERT_D},
+        {HILBERT_D, HILBERT_C, HILBERT_C, HILBERT_A},
+        {HILBERT_C, HILBERT_D, HILBERT_D, HILBERT_B}
+    };
+    const float HILBERT_MOVES[4][3][2] = {
+        {{0.0f, 1.0f}, {1.0f, 0.0f}, {0.0f, -1.0f}},
+        {{1.0f, 0.0f}, {0.0f, 1.0f}, {-1.0f, 0.0f}},
+        {{-1.0f, 0.0f}, {0.0f, -1.0f}, {1.0f, 0.0f}},
+        {{0.0f, -1.0f}, {-1.0f, 0.0f}, {0.0f, 1.0f}}
+    };
+
+    //Every orientation is the A curve under a linear map: identity, swap x and y,
+    //swap and negate, negate. Stored as the images of the x and y axes.
+    const float HILBERT_AXES[4][2][2] = {
+        {{1.0f, 0.0f}, {0.0f, 1.0f}},
+        {{0.0f, 1.0f}, {1.0f, 0.0f}},
+        {{0.0f, -1.0f}, {-1.0f, 0.0f}},
+        {{-1.0f, 0.0f}, {0.0f, -1.0f}}
+    };
+
+    //Walks the top `level` levels of the curve, emitting one instance of the base curve per leaf
+    //and one line per joining move. Sub-curves of any level are joined by a single segment,
+    //so a leaf moves the position by the base curve's width along its own x axis.
+    void addHilbertInstances(HilbertType type, int level, float baseWidth, float segmentLength,
+        glm::vec3& currentPosition, InstancedGeometryData& instanced, GeometryData& joins)
+    {
+        if (level == 0)
+        {
+            glm::mat3 transform;
+            transform[0] = glm::vec3(HILBERT_AXES[type][0][0], HILBERT_AXES[type][0][1], 0.0f);
+            transform[1] = glm::vec3(HILBERT_AXES[type][1][0], HILBERT_AXES[type][1][1], 0.0f);
+            transform[2] = glm::vec3(currentPosition[0], currentPosition[1], 1.0f);
+            instanced.transforms.push_back(transform);
+            instanced.colourOffsets.push_back(glm::vec3(0.0f));
+
+            currentPosition = glm::vec3(currentPosition[0] + HILBERT_AXES[type][0][0] * baseWidth,
+                                        currentPosition[1] + HILBERT_AXES[type][0][1] * baseWidth, 1.0f);
+            return;
+        }
+
+        for (int child = 0; child < 4; child++)
+        {
+            addHilbertInstances(HILBERT_CHILDREN[type][child], level - 1, baseWidth, segmentLength,
+                currentPosition, instanced, joins);
+            if (child < 3)
+            {
+                joins.verts.push_back(currentPosition);
+                currentPosition = glm::vec3(currentPosition[0] + HILBERT_MOVES[type][child][0] * segmentLength,
+                                            currentPosition[1] + HILBERT_MOVES[type][child][1] * segmentLength, 1.0f);
+                joins.verts.push_back(currentPosition);
+                joins.colors.push_back(RED_COLOUR);
+                joins.colors.push_back(RED_COLOUR);
+            }
+        }
+    }
+
+    //Cell (x, y) of the point at index `index` along a Hilbert curve of the given level
+    //(Lam and Shapiro's loop-free method, Hacker's Delight 16-3). Every pair of index bits
+    //picks a quadrant; a parallel-prefix xor carries the swap and complement each quadrant
+    //applies to the ones below it, leaving x and y bits interleaved for the caller to split.
+    std::uint64_t getInterleavedHilbertCell(std::uint64_t index, int level)
+    {
+        const std::uint64_t EVEN_BITS = 0x5555555555555555ull;
+
+        //Pad on the left with "01" pairs, which leave the orientation unchanged
+        std::uint64_t padded = index | (EVEN_BITS << (2 * level));
+        std::uint64_t shifted = (padded >> 1) & EVEN_BITS;
+        std::uint64_t swapAndComplement = ((padded & EVEN_BITS) + shifted) ^ EVEN_BITS;
+        swapAndComplement ^= swapAndComplement >> 2;
+        swapAndComplement ^= swapAndComplement >> 4;
+        swapAndComplement ^= swapAndComplement >> 8;
+        swapAndComplement ^= swapAndComplement >> 16;
+        swapAndComplement ^= swapAndComplement >> 32;
+        std::uint64_t swap = swapAndComplement & EVEN_BITS;
+        std::uint64_t complement = (swapAndComplement >> 1) & EVEN_BITS;
+
+        std::uint64_t t = (padded & swap) ^ complement;
+        std::uint64_t cell = padded ^ shifted ^ t ^ (t << 1);
+        return cell & ((std::uint64_t(1) << (2 * level)) - 1);
+    }
+
+    //Splits an interleaved cell into its odd (x) and even (y) bits
+    void deinterleave(std::uint64_t cell, std::uint32_t& x, std::uint32_t& y)
+    {
+        std::uint64_t t;
+        t = (cell ^ (cell >> 1)) & 0x2222222222222222ull; cell ^= t ^ (t << 1);
+        t = (cell ^ (cell >> 2)) & 0x0C0C0C0C0C0C0C0Cull; cell ^= t ^ (t << 2);
+        t = (cell ^ (cell >> 4)) & 0x00F000F000F000F0ull; cell ^= t ^ (t << 4);
+        t = (cell ^ (cell >> 8)) & 0x0000FF000000FF00ull; cell ^= t ^ (t << 8);
+        t = (cell ^ (cell >> 16)) & 0x00000000FFFF0000ull; cell ^= t ^ (t << 16);
+        x = static_cast<std::uint32_t>(cell >> 32);
+        y = static_cast<std::uint32_t>(cell);
+    }
+
+    //Writes the points with indices [begin, end) of a Hilbert curve of the given level,
+    //starting from `origin` and turning first upwards (orientation A)
+    void writeHilbertPointsScalar(int level, std::uint64_t begin, std::uint64_t end,
+        glm::vec3 origin, float segmentLength, glm::vec3* out)
+    {
+        for (std::uint64_t index = begin; index < end; index++)
+        {
+            std::uint32_t x;
+            std::uint32_t y;
+            deinterleave(getInterleavedHilbertCell(index, level), x, y);
+            *out++ = glm::vec3(origin[0] + static_cast<float>(x) * segmentLength,
+                               origin[1] + static_cast<float>(y) * segmentLength, 1.0f);
+        }
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    //Same, splitting the bits with a single pext each
+    __attribute__((target("bmi2")))
+    void writeHilbertPointsBmi2(int level, std::uint64_t begin, std::uint64_t end,
+        glm::vec3 origin, float segmentLength, glm::vec3* out)
+    {
+        for (std::uint64_t index = begin; index < end; index++)
+        {
+            std::uint64_t cell = getInterleavedHilbertCell(index, level);
+            std::uint32_t x = static_cast<std::uint32_t>(_pext_u64(cell, 0xAAAAAAAAAAAAAAAAull));
+            std::uint32_t y = static_cast<std::uint32_t>(_pext_u64(cell, 0x5555555555555555ull));
+            *out++ = glm::vec3(origin[0] + static_cast<float>(x) * segmentLength,
+                               origin[1] + static_cast<float>(y) * segmentLength, 1.0f);
+        }
+    }
+
+    bool cpuHasBmi2()
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("bmi2");
+    }
+#else
+    bool cpuHasBmi2()
+    {
+        return false;
+    }
+#endif
+
+    const bool HILBERT_USE_BMI2 = cpuHasBmi2();
+
+    void writeHilbertPoints(int level, std::uint64_t begin, std::uint64_t end,
+        glm::vec3 origin, float segmentLength, glm::vec3* out)
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        if (HILBERT_USE_BMI2)
+        {
+            writeHilbertPointsBmi2(level, begin, end, origin, segmentLength, out);
+            return;
+        }
+#endif
+        writeHilbertPointsScalar(level, begin, end, origin, segmentLength, out);
+    }
+}
+
+void GeometryBuilder::buildNestedSquares(int numberOfIterations, std::vector<GeometryData>& objects)
+{
+    NestedSquaresGenerator().build(numberOfIterations, objects);
+}
+
+//Every level is the level before at half the size, turned a quarter turn clockwise
+//(the inner diamond's midpoints start one corner further round)
+void GeometryBuilder::buildNestedSquaresInstanced(int numberOfIterations, InstancedGeometryData& instanced,
+    std::vector<GeometryData>& objects)
+{
+    std::vector<GeometryData> firstLevel;
+    NestedSquaresGenerator().build(1, firstLevel);
+    instanced.base = firstLevel[0];
+
+    instanced.transforms.resize(numberOfIterations);
+    instanced.colourOffsets.assign(numberOfIterations, glm::vec3(0.0f));
+    glm::mat3 transform;
+    for (int i = 0; i < numberOfIterations; i++)
+    {
+        instanced.transforms[i] = transform;
+        glm::vec3 xAxis = transform[0];
+        transform[0] = -0.5f * transform[1];
+        transform[1] = 0.5f * xAxis;
+    }
+    objects.clear();
+}
+
+void GeometryBuilder::NestedSquaresGenerator::build(int numberOfIterations, std::vector<GeometryData>& objects)
+{
+    objects.clear();
+    std::vector<glm::vec3> outerSquare;
+
+    outerSquare.push_back(glm::vec3(-0.9f, 0.9f, 1.0f));
+    outerSquare.push_back(glm::vec3(0.9f, 0.9f, 1.0f));
+    outerSquare.push_back(glm::vec3(0.9f, -0.9f, 1.0f));
+    outerSquare.push_back(glm::vec3(-0.9f, -0.9f, 1.0f));
+
+    for(int i = 0; i < numberOfIterations; i++)
+    {
+        ThreadTools::throwIfCancelled();
+        outerSquare = drawSingleSquareWithNestedDiamond(outerSquare, objects);
+    }
+
+    nextOuterSquare = outerSquare;
+    level = numberOfIterations;
+}
+
+void GeometryBuilder::NestedSquaresGenerator::buildNextLevel(GeometryAppend& append)
+{
+    nextOuterSquare = drawSingleSquareWithNestedDiamond(nextOuterSquare, append.newObjects);
+    level++;
+}
+
+void GeometryBuilder::buildSpiral(int numberOfIterations, std::vector<GeometryData>& objects)
+{
+    buildSpiral(numberOfIterations, objects, DEFAULT_PIXELS_PER_UNIT);
+}
+
+//Turn k covers u in [k, k + 1) at radius u / numberOfIterations, split into as many equal-angle
+//segments as its outer radius needs on screen. Turn sizes are known up front, so the buffer is
+//sized exactly and filled in parallel slices of vertices, which may start part way into a
+//turn. Within a turn the direction is stepped by a fixed rotation, restarting from an exact
+//angle at every turn and slice so the error never builds up.
+void GeometryBuilder::buildSpiral(int numberOfIterations, std::vector<GeometryData>& objects, float pixelsPerUnit)
+{
+    objects.clear();
+    objects.resize(1);
+    GeometryData& spiral = objects[0];
+    spiral.primitive = LINE_STRIP_PRIMITIVE;
+
+    double turns = static_cast<double>(numberOfIterations);
+    std::vector<std::size_t> firstVertex(numberOfIterations + 1, 0);
+    for (int turn = 0; turn < numberOfIterations; turn++)
+    {
+        double outerRadius = (turn + 1) / turns * pixelsPerUnit;
+        firstVertex[turn + 1] = firstVertex[turn] + getSpiralSegmentsPerTurn(outerRadius);
+    }
+
+    //One more vertex closes the last turn at u = numberOfIterations
+    std::size_t vertexCount = firstVertex[numberOfIterations] + 1;
+    spiral.verts.resize(vertexCount);
+    spiral.colors.resize(vertexCount);
+    glm::vec3* verts = spiral.verts.data();
+    glm::vec3* colors = spiral.colors.data();
+
+    ThreadTools::parallelFor(vertexCount - 1, SPIRAL_MINIMUM_SLICE,
+        [verts, colors, turns, &firstVertex](std::size_t begin, std::size_t end, unsigned int workerIndex)
+    {
+        //Turn holding the slice's first vertex
+        std::size_t turn = std::upper_bound(firstVertex.begin(), firstVertex.end(), begin) - firstVertex.begin() - 1;
+        for (; turn + 1 < firstVertex.size() && firstVertex[turn] < end; turn++)
+        {
+            std::size_t segments = firstVertex[turn + 1] - firstVertex[turn];
+            std::size_t first = std::max(begin, firstVertex[turn]) - firstVertex[turn];
+            std::size_t last = std::min(end, firstVertex[turn + 1]) - firstVertex[turn];
+            double stepAngle = 2.0 * M_PI / static_cast<double>(segments);
+            double stepCos = std::cos(stepAngle);
+            double stepSin = std::sin(stepAngle);
+            double directionX = first ? std::cos(stepAngle * first) : 1.0;
+            double directionY = first ? std::sin(stepAngle * first) : 0.0;
+            for (std::size_t i = first; i < last; i++)
+            {
+                double t = (static_cast<double>(turn) + static_cast<double>(i) / static_cast<double>(segments)) / turns;
+                verts[firstVertex[turn] + i] = glm::vec3(static_cast<float>(t * directionX),
+                                                         static_cast<float>(t * directionY), 1.0f);
+                colors[firstVertex[turn] + i] = getSpiralColour(static_cast<float>(t));
+
+                double rotatedX = directionX * stepCos - directionY * stepSin;
+                directionY = directionX * stepSin + directionY * stepCos;
+                directionX = rotatedX;
+            }
+        }
+    });
+
+    verts[vertexCount - 1] = glm::vec3(1.0f, 0.0f, 1.0f);
+    colors[vertexCount - 1] = getSpiralColour(1.0f);
+}
+
+//Triangle t of the gasket is found straight from its base-3 address: digit k (most significant
+//first) picks which corner's half-size copy to descend into at depth k. Every triangle is
+//independent, so the whole level is written in parallel into one buffer and drawn in one call.
+void GeometryBuilder::buildSierpinskiTriangles(int numberOfIterations, std::vector<GeometryData>& objects)
+{
+    objects.clear();
+    objects.push_back(GeometryData());
+    GeometryData& gasket = objects.back();
+    gasket.primitive = TRIANGLES_PRIMITIVE;
+
+    int depth = numberOfIterations - 1;
+    std::size_t triangleCount = powerOfThree(depth);
+    gasket.verts.resize(3 * triangleCount);
+    gasket.colors.resize(3 * triangleCount);
+    writeGasketTriangles(depth, 3.0f / static_cast<float>(triangleCount), gasket.verts.data(), gasket.colors.data());
+}
+
+//Level depth + 1 is three copies of level depth, halved towards each outer corner. Copy c takes
+//the triangle addresses with leading digit c, which lowers every colour channel by c thirds
+//after the previous level's colours are squeezed into a third: colour' = colour / 3 + (2 - c) / 3.
+//That only holds from depth 1 on, so the first two levels are always built in full.
+void GeometryBuilder::buildSierpinskiTrianglesNextLevel(int numberOfIterations, std::vector<GeometryData>& objects)
+{
+    int depth = numberOfIterations - 1;
+    if (depth < 2 || objects.size() != 1 || objects[0].verts.size() != 3 * powerOfThree(depth - 1))
+    {
+        buildSierpinskiTriangles(numberOfIterations, objects);
+        return;
+    }
+
+    GeometryData& gasket = objects[0];
+    gasket.primitive = TRIANGLES_PRIMITIVE;
+    std::size_t previousVertexCount = gasket.verts.size();
+    gasket.verts.resize(3 * previousVertexCount);
+    gasket.colors.resize(3 * previousVertexCount);
+
+    glm::vec3 outerTriangle[3];
+    getOuterTriangle(outerTriangle);
+
+    glm::mat3 halve(0.5f);
+    halve[2][2] = 1.0f;
+    glm::mat3 squeeze(1.0f / 3.0f);
+
+    //Copy 0 overwrites the previous level, so it goes last
+    for (int corner = 2; corner >= 0; corner--)
+    {
+        glm::vec3 offset(0.5f * outerTriangle[corner][0], 0.5f * outerTriangle[corner][1], 0.0f);
+        glm::vec3 colourOffset(static_cast<float>(2 - corner) / 3.0f);
+        std::size_t first = corner * previousVertexCount;
+        transformCopy(halve, offset, gasket.verts.data(), gasket.verts.data() + first, previousVertexCount);
+        transformCopy(squeeze, colourOffset, gasket.colors.data(), gasket.colors.data() + first, previousVertexCount);
+    }
+}
+
+//The level is drawn as 3^(depth - baseDepth) scaled copies of a full-size gasket of baseDepth.
+//Because 3^baseDepth is a multiple of 3, the colour of copy i is the base colour lowered by
+//i * 3^(baseDepth - 1) colour steps on every channel, which becomes its colour offset.
+void GeometryBuilder::buildSierpinskiTrianglesInstanced(int numberOfIterations, InstancedGeometryData& instanced,
+    std::vector<GeometryData>& objects)
+{
+    objects.clear();
+    int depth = numberOfIterations - 1;
+    int baseDepth = std::min(depth, INSTANCED_SIERPINSKI_BASE_DEPTH);
+    int instanceDepth = depth - baseDepth;
+    std::size_t baseTriangleCount = powerOfThree(baseDepth);
+    std::size_t instanceCount = powerOfThree(instanceDepth);
+    float colourStep = 3.0f / static_cast<float>(baseTriangleCount * instanceCount);
+
+    GeometryData& base = instanced.base;
+    base.primitive = TRIANGLES_PRIMITIVE;
+    base.verts.resize(3 * baseTriangleCount);
+    base.colors.resize(3 * baseTriangleCount);
+    writeGasketTriangles(baseDepth, colourStep, base.verts.data(), base.colors.data());
+
+    glm::vec3 outerTriangle[3];
+    getOuterTriangle(outerTriangle);
+
+    float scale = std::ldexp(1.0f, -instanceDepth);
+    float instanceColourStep = baseDepth > 0 ? colourStep * static_cast<float>(baseTriangleCount / 3) : 0.0f;
+    instanced.transforms.resize(instanceCount);
+    instanced.colourOffsets.resize(instanceCount);
+    for (std::size_t instance = 0; instance < instanceCount; instance++)
+    {
+        float offsetX;
+        float offsetY;
+        getGasketOffset(instance, instanceDepth, outerTriangle, offsetX, offsetY);
+
+        glm::mat3 transform(scale);
+        transform[2] = glm::vec3(offsetX, offsetY, 1.0f);
+        instanced.transforms[instance] = transform;
+        instanced.colourOffsets[instance] = glm::vec3(-instanceColourStep * static_cast<float>(instance));
+    }
+}
+
+void GeometryBuilder::buildRandomSierpinski(int numberOfIterations, std::vector<GeometryData>& objects)
+{
+    RandomSierpinskiGenerator(Random::DEFAULT_SEED).build(numberOfIterations, objects);
+}
+
+void GeometryBuilder::buildRandomSierpinskiDensity(int numberOfIterations, DensityHistogram& histogram)
+{
+    RandomSierpinskiGenerator(Random::DEFAULT_SEED).buildDensity(numberOfIterations, histogram);
+}
+
+GeometryBuilder::RandomSierpinskiGenerator::RandomSierpinskiGenerator(std::uint64_t seed)
+: seed(seed), random(seed, 0)
+{
+    getOuterTriangle(outerTriangle);
+    currentPoint = outerTriangle[0];
+}
+
+void GeometryBuilder::RandomSierpinskiGenerator::setSeed(std::uint64_t newSeed)
+{
+    seed = newSeed;
+    level = 0;
+}
+
+void GeometryBuilder::RandomSierpinskiGenerator::build(int numberOfIterations, std::vector<GeometryData>& objects)
+{
+    objects.clear();
+    std::size_t totalPoints = RANDOM_SIERPINSKI_POINTS_PER_ITERATION * static_cast<std::size_t>(numberOfIterations);
+
+    GeometryData randomSierpinski;
+    randomSierpinski.verts.resize(totalPoints + 1);
+    randomSierpinski.colors.assign(totalPoints + 1, TEAL_COLOUR);
+
+    currentPoint = outerTriangle[0];
+    random = Random::Stream(seed, 0);
+    randomSierpinski.verts[0] = currentPoint;
+    advanceRandomSierpinski(currentPoint, outerTriangle, random, randomSierpinski.verts.data() + 1, totalPoints);
+
+    randomSierpinski.primitive = POINTS_PRIMITIVE;
+    objects.push_back(randomSierpinski);
+    level = numberOfIterations;
+}
+
+void GeometryBuilder::RandomSierpinskiGenerator::buildNextLevel(GeometryAppend& append)
+{
+    GeometryData& tail = append.tail;
+    tail.primitive = POINTS_PRIMITIVE;
+    tail.verts.resize(RANDOM_SIERPINSKI_POINTS_PER_ITERATION);
+    tail.colors.assign(RANDOM_SIERPINSKI_POINTS_PER_ITERATION, TEAL_COLOUR);
+    advanceRandomSierpinski(currentPoint, outerTriangle, random, tail.verts.data(), tail.verts.size());
+    level++;
+}
+
+void GeometryBuilder::RandomSierpinskiGenerator::buildDensity(int numberOfIterations, DensityHistogram& histogram)
+{
+    histogram.clear();
+    histogram.colour = TEAL_COLOUR;
+
+    currentPoint = outerTriangle[0];
+    random = Random::Stream(seed, 0);
+    histogram.addPoints(&currentPoint, 1);
+    binPoints(RANDOM_SIERPINSKI_POINTS_PER_ITERATION * static_cast<std::size_t>(numberOfIterations), histogram);
+    level = numberOfIterations;
+}
+
+void GeometryBuilder::RandomSierpinskiGenerator::buildNextDensityLevel(DensityHistogram& histogram)
+{
+    binPoints(RANDOM_SIERPINSKI_POINTS_PER_ITERATION, histogram);
+    level++;
+}
+
+void GeometryBuilder::RandomSierpinskiGenerator::binPoints(std::size_t count, DensityHistogram& histogram)
+{
+    std::vector<glm::vec3> chunk(std::min(count, DENSITY_CHUNK_SIZE));
+    for (std::size_t done = 0; done < count; done += chunk.size())
+    {
+        std::size_t chunkCount = std::min(chunk.size(), count - done);
+        advanceRandomSierpinski(currentPoint, outerTriangle, random, chunk.data(), chunkCount);
+        histogram.addPoints(chunk.data(), chunkCount);
+    }
+}
+
+//Note that this method was adapted from https://people.sc.fsu.edu/~jburkardt/cpp_src/fern_opengl/fern.cpp
+void GeometryBuilder::buildBarnsleyFern(int numberOfIterations, std::vector<GeometryData>& objects)
+{
+    BarnsleyFernGenerator(Random::DEFAULT_SEED).build(numberOfIterations, objects);
+}
+
+void GeometryBuilder::buildBarnsleyFernDensity(int numberOfIterations, DensityHistogram& histogram)
+{
+    BarnsleyFernGenerator(Random::DEFAULT_SEED).buildDensity(numberOfIterations, histogram);
+}
+
+GeometryBuilder::BarnsleyFernGenerator::BarnsleyFernGenerator(std::uint64_t seed)
+: seed(seed)
+{
+}
+
+void GeometryBuilder::BarnsleyFernGenerator::setSeed(std::uint64_t newSeed)
+{
+    seed = newSeed;
+    level = 0;
+}
+
+void GeometryBuilder::BarnsleyFernGenerator::build(int numberOfIterations, std::vector<GeometryData>& objects)
+{
+    objects.clear();
+    objects.push_back(GeometryData());
+    GeometryData& barnsleyFern = objects.back();
+    barnsleyFern.primitive = POINTS_PRIMITIVE;
+
+    std::size_t totalPoints = FERN_POINTS_PER_ITERATION * static_cast<std::size_t>(numberOfIterations);
+    barnsleyFern.verts.resize(totalPoints);
+    barnsleyFern.colors.assign(totalPoints, GOLD_COLOUR);
+    generateFernLevels(seed, 0, numberOfIterations, barnsleyFern.verts.data());
+    level = numberOfIterations;
+}
+
+void GeometryBuilder::BarnsleyFernGenerator::buildNextLevel(GeometryAppend& append)
+{
+    GeometryData& tail = append.tail;
+    tail.primitive = POINTS_PRIMITIVE;
+    tail.verts.resize(FERN_POINTS_PER_ITERATION);
+    tail.colors.assign(FERN_POINTS_PER_ITERATION, GOLD_COLOUR);
+    generateFernLevels(seed, level, 1, tail.verts.data());
+    level++;
+}
+
+void GeometryBuilder::BarnsleyFernGenerator::buildDensity(int numberOfIterations, DensityHistogram& histogram)
+{
+    histogram.clear();
+    histogram.colour = GOLD_COLOUR;
+    binFernLevels(seed, 0, numberOfIterations, histogram);
+    level = numberOfIterations;
+}
+
+void GeometryBuilder::BarnsleyFernGenerator::buildNextDensityLevel(DensityHistogram& histogram)
+{
+    binFernLevels(seed, level, 1, histogram);
+    level++;
+}
+
+void GeometryBuilder::setFernBackend(FernKernels::Backend backend)
+{
+    fernBackend = FernKernels::isSupported(backend) ? backend : FernKernels::SCALAR_BACKEND;
+}
+
+FernKernels::Backend GeometryBuilder::getFernBackend()
+{
+    return fernBackend;
+}
+
+//Level n + 1 is four copies of level n on a grid twice as fine: the first swapped along the
+//diagonal, the middle two shifted up and up-right, and the last swapped along the other diagonal.
+//In buffer coordinates each copy is also rescaled, since the segment length is 1 / (2n).
+//The point at index 0 (the starting corner) is not in the strip, so for the later copies it
+//is transformed separately to join them up.
+void GeometryBuilder::buildHilbertCurveNextLevel(int numberOfIterations, std::vector<GeometryData>& objects)
+{
+    PROFILE_ZONE("Hilbert curve next level");
+    int previousLevel = numberOfIterations - 1;
+    std::size_t copySize = std::size_t(1) << (2 * previousLevel);
+    if (previousLevel < 1 || objects.size() != 1 || objects[0].verts.size() != copySize - 1)
+    {
+        buildHilbertCurve(numberOfIterations, objects);
+        return;
+    }
+
+    GeometryData& hilbertCurve = objects[0];
+    hilbertCurve.primitive = LINE_STRIP_PRIMITIVE;
+    std::size_t previousVertexCount = copySize - 1;
+    hilbertCurve.verts.resize(4 * copySize - 1);
+    hilbertCurve.colors.resize(4 * copySize - 1, RED_COLOUR);
+
+    float previousSegmentLength = 1.0f / (2.0f * static_cast<float>(previousLevel));
+    float segmentLength = 1.0f / (2.0f * static_cast<float>(numberOfIterations));
+    float side = static_cast<float>(std::size_t(1) << previousLevel);
+    glm::vec3 startingPoint(-1.0f, -1.0f, 1.0f);
+
+    //Grid maps of the copies, as (x axis, y axis, translation) in cells of the new level
+    const float COPY_AXES[4][2][2] = {
+        {{0.0f, 1.0f}, {1.0f, 0.0f}},
+        {{1.0f, 0.0f}, {0.0f, 1.0f}},
+        {{1.0f, 0.0f}, {0.0f, 1.0f}},
+        {{0.0f, -1.0f}, {-1.0f, 0.0f}}
+    };
+    const float COPY_TRANSLATIONS[4][2] = {
+        {0.0f, 0.0f},
+        {0.0f, side},
+        {side, side},
+        {2.0f * side - 1.0f, side - 1.0f}
+    };
+
+    //Copy 0 overwrites the previous level, so it goes last
+    for (int copy = 3; copy >= 0; copy--)
+    {
+        //p' = start + (axes * (p - start) / previousSegmentLength + translation) * segmentLength
+        float ratio = segmentLength / previousSegmentLength;
+        glm::mat3 linear;
+        linear[0] = glm::vec3(COPY_AXES[copy][0][0] * ratio, COPY_AXES[copy][0][1] * ratio, 0.0f);
+        linear[1] = glm::vec3(COPY_AXES[copy][1][0] * ratio, COPY_AXES[copy][1][1] * ratio, 0.0f);
+        linear[2] = glm::vec3(0.0f, 0.0f, 1.0f);
+        glm::vec3 movedStart = linear * startingPoint;
+        glm::vec3 offset(startingPoint[0] - movedStart[0] + COPY_TRANSLATIONS[copy][0] * segmentLength,
+                         startingPoint[1] - movedStart[1] + COPY_TRANSLATIONS[copy][1] * segmentLength, 0.0f);
+
+        std::size_t first = copy * copySize;
+        if (copy > 0)
+        {
+            hilbertCurve.verts[first - 1] = linear * startingPoint + offset;
+        }
+        transformCopy(linear, offset, hilbertCurve.verts.data(), hilbertCurve.verts.data() + first,
+            previousVertexCount);
+    }
+}
+
+//The curve is drawn as copies of a level-INSTANCED_HILBERT_BASE_LEVEL curve in its four
+//orientations, plus one line for every move joining two copies. The first copy is drawn as
+//its own strip without its first vertex, since the starting corner is not part of the curve.
+void GeometryBuilder::buildHilbertCurveInstanced(int numberOfIterations, InstancedGeometryData& instanced,
+    std::vector<GeometryData>& objects)
+{
+    PROFILE_ZONE("Hilbert curve instanced");
+    objects.clear();
+    float segmentLength = 1.0f / (2.0f * static_cast<float>(numberOfIterations));
+    int baseLevel = std::min(numberOfIterations, INSTANCED_HILBERT_BASE_LEVEL);
+    int instanceLevel = numberOfIterations - baseLevel;
+
+    GeometryData& base = instanced.base;
+    base.verts.clear();
+    base.colors.clear();
+    base.primitive = LINE_STRIP_PRIMITIVE;
+    std::size_t baseVertexCount = std::size_t(1) << (2 * baseLevel);
+    base.verts.resize(baseVertexCount);
+    base.colors.assign(baseVertexCount, RED_COLOUR);
+    writeHilbertPoints(baseLevel, 0, baseVertexCount, glm::vec3(0.0f, 0.0f, 1.0f), segmentLength, base.verts.data());
+
+    instanced.transforms.clear();
+    instanced.colourOffsets.clear();
+    GeometryData joins;
+    joins.primitive = LINES_PRIMITIVE;
+    float baseWidth = static_cast<float>((1 << baseLevel) - 1) * segmentLength;
+    glm::vec3 startingPoint(-1.0f, -1.0f, 1.0);
+    addHilbertInstances(HILBERT_A, instanceLevel, baseWidth, segmentLength, startingPoint, instanced, joins);
+
+    GeometryData firstCopy;
+    firstCopy.primitive = LINE_STRIP_PRIMITIVE;
+    firstCopy.verts.reserve(baseVertexCount - 1);
+    firstCopy.colors.assign(baseVertexCount - 1, RED_COLOUR + instanced.colourOffsets.front());
+    for (std::size_t i = 1; i < baseVertexCount; i++)
+    {
+        glm::vec3 point = instanced.transforms.front() * glm::vec3(base.verts[i][0], base.verts[i][1], 1.0f);
+        firstCopy.verts.push_back(glm::vec3(point[0], point[1], base.verts[i][2]));
+    }
+    instanced.transforms.erase(instanced.transforms.begin());
+    instanced.colourOffsets.erase(instanced.colourOffsets.begin());
+    objects.push_back(firstCopy);
+
+    if (!joins.verts.empty())
+    {
+        objects.push_back(joins);
+    }
+}
+
+//Every vertex is computed from its index along the curve, so the buffer is sized once and
+//filled in parallel slices. As before, the starting corner itself is not part of the strip.
+//(The orientation and scale follow the recursive version adapted from
+//http://www.latenightpc.com/blog/archives/2007/11/13/the-hilbert-curve-in-javal-lua-and-c)
+void GeometryBuilder::buildHilbertCurve(int numberOfIterations, std::vector<GeometryData>& objects)
+{
+    PROFILE_ZONE("Hilbert curve");
+    objects.clear();
+    objects.resize(1);
+    GeometryData& hilbertCurve = objects[0];
+    hilbertCurve.primitive = LINE_STRIP_PRIMITIVE;
+    float segmentLength = 1.0f / (2.0f * static_cast<float>(numberOfIterations));
+    glm::vec3 startingPoint(-1.0f, -1.0f, 1.0);
+
+    std::size_t vertexCount = (std::size_t(1) << (2 * numberOfIterations)) - 1;
+    hilbertCurve.verts.resize(vertexCount);
+    hilbertCurve.colors.resize(vertexCount);
+    glm::vec3* verts = hilbertCurve.verts.data();
+    glm::vec3* colors = hilbertCurve.colors.data();
+    ThreadTools::parallelFor(vertexCount, HILBERT_MINIMUM_SLICE,
+        [verts, colors, numberOfIterations, startingPoint, segmentLength](std::size_t begin, std::size_t end,
+            unsigned int workerIndex)
+    {
+        writeHilbertPoints(numberOfIterations, begin + 1, end + 1, startingPoint, segmentLength, verts + begin);
+        std::fill(colors + begin, colors + end, RED_COLOUR);
+    });
+}
@@ -0,0 +1,183 @@
+/*
+ * GeometryBuilder.h
+ *	CPU-only generation of the scene geometry. Nothing in here touches OpenGL,
+ *	so the generators can be run, timed and threaded without a window or context.
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef GEOMETRYBUILDER_H_
+#define GEOMETRYBUILDER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "DensityHistogram.h"
+#include "FernKernels.h"
+#include "Random.h"
+
+//How the renderer should interpret the generated vertices
+//(mapped to a GL draw mode by RenderingEngine at upload time)
+enum PrimitiveType
+{
+    POINTS_PRIMITIVE,
+    LINE_STRIP_PRIMITIVE,
+    TRIANGLES_PRIMITIVE,
+    LINES_PRIMITIVE
+};
+
+//Plain vertex and colour buffers filled by the generators
+struct GeometryData
+{
+    GeometryData() : primitive(POINTS_PRIMITIVE) {}
+
+    std::vector<glm::vec3> verts;
+    std::vector<glm::vec3> colors;
+    PrimitiveType primitive;
+};
+
+//A level drawn as copies of one small base geometry
+struct InstancedGeometryData
+{
+    GeometryData base;
+    //Per-copy 2D affine transform, applied to a base vertex as transform * vec3(x, y, 1)
+    std::vector<glm::mat3> transforms;
+    //Added to the base colours of each copy
+    std::vector<glm::vec3> colourOffsets;
+};
+
+//What one more level adds to an existing build
+struct GeometryAppend
+{
+    //Vertices to add to the end of the last existing object
+    GeometryData tail;
+    //Objects to add after the existing ones
+    std::vector<GeometryData> newObjects;
+};
+
+//Each builder clears `objects` and fills it with the geometry for the given level
+namespace GeometryBuilder
+{
+    void buildNestedSquares(int numberOfIterations, std::vector<GeometryData>& objects);
+    void buildSpiral(int numberOfIterations, std::vector<GeometryData>& objects);
+    //Spiral tessellated for a window showing pixelsPerUnit pixels per unit of [-1, 1]
+    //(the overload above assumes the default 512 pixel window)
+    void buildSpiral(int numberOfIterations, std::vector<GeometryData>& objects, float pixelsPerUnit);
+    void buildSierpinskiTriangles(int numberOfIterations, std::vector<GeometryData>& objects);
+    void buildRandomSierpinski(int numberOfIterations, std::vector<GeometryData>& objects);
+    void buildBarnsleyFern(int numberOfIterations, std::vector<GeometryData>& objects);
+    void buildHilbertCurve(int numberOfIterations, std::vector<GeometryData>& objects);
+
+    //Replace level numberOfIterations - 1 in `objects`, as built by the matching builder above,
+    //with level numberOfIterations, made of transformed copies of it instead of from scratch.
+    //Anything else in `objects` is rebuilt in full.
+    void buildSierpinskiTrianglesNextLevel(int numberOfIterations, std::vector<GeometryData>& objects);
+    void buildHilbertCurveNextLevel(int numberOfIterations, std::vector<GeometryData>& objects);
+
+    //Density variants of the chaos-game scenes: the same points, binned into `histogram`
+    //(cleared first) instead of stored. The free chaos-game builders use Random::DEFAULT_SEED.
+    void buildRandomSierpinskiDensity(int numberOfIterations, DensityHistogram& histogram);
+    void buildBarnsleyFernDensity(int numberOfIterations, DensityHistogram& histogram);
+
+    //Instanced variants of the self-similar scenes, storing a small base level once plus one
+    //transform per copy. `objects` receives anything drawn once, uninstanced, on top
+    //(the segments joining the copies of the Hilbert curve).
+    void buildNestedSquaresInstanced(int numberOfIterations, InstancedGeometryData& instanced,
+        std::vector<GeometryData>& objects);
+    void buildSierpinskiTrianglesInstanced(int numberOfIterations, InstancedGeometryData& instanced,
+        std::vector<GeometryData>& objects);
+    void buildHilbertCurveInstanced(int numberOfIterations, InstancedGeometryData& instanced,
+        std::vector<GeometryData>& objects);
+
+    //Selects the kernel used by buildBarnsleyFern (defaults to the widest the CPU supports;
+    //unsupported choices fall back to scalar)
+    void setFernBackend(FernKernels::Backend backend);
+    FernKernels::Backend getFernBackend();
+
+    //Generators for scenes where level n+1 is level n plus more data. They keep the
+    //state of their last build, so stepping up a level only generates the new part.
+    class AppendingGenerator
+    {
+    public:
+        AppendingGenerator() : level(0) {}
+        virtual ~AppendingGenerator() {}
+
+        //Clears `objects` and generates levels 1 to numberOfIterations from scratch.
+        //A build cancelled through ThreadTools leaves the generator at the level it was at before.
+        virtual void build(int numberOfIterations, std::vector<GeometryData>& objects) = 0;
+
+        //Generates only what level getLevel() + 1 adds to the last build
+        virtual void buildNextLevel(GeometryAppend& append) = 0;
+
+        //Level the generator's state currently corresponds to
+        int getLevel() const { return level; }
+
+    protected:
+        int level;
+    };
+
+    //One square with its nested diamond per level
+    class NestedSquaresGenerator : public AppendingGenerator
+    {
+    public:
+        virtual void build(int numberOfIterations, std::vector<GeometryData>& objects);
+        virtual void buildNextLevel(GeometryAppend& append);
+
+    private:
+        //Outer square of the next level
+        std::vector<glm::vec3> nextOuterSquare;
+    };
+
+    //250 more points of the same random walk per level. The walk draws from stream 0 of its
+    //seed, restarted by every full build, so a seed always gives the same picture.
+    class RandomSierpinskiGenerator : public AppendingGenerator
+    {
+    public:
+        explicit RandomSierpinskiGenerator(std::uint64_t seed);
+
+        //Restarts the generator, so the next level is built in full from the new seed
+        void setSeed(std::uint64_t newSeed);
+        std::uint64_t getSeed() const { return seed; }
+
+        virtual void build(int numberOfIterations, std::vector<GeometryData>& objects);
+        virtual void buildNextLevel(GeometryAppend& append);
+
+        //Density variants, adding the same points to a histogram instead
+        void buildDensity(int numberOfIterations, DensityHistogram& histogram);
+        void buildNextDensityLevel(DensityHistogram& histogram);
+
+    private:
+        void binPoints(std::size_t count, DensityHistogram& histogram);
+
+        std::uint64_t seed;
+        Random::Stream random;
+        glm::vec3 outerTriangle[3];
+        glm::vec3 currentPoint;
+    };
+
+    //A million more points per level. Every level is made of its own random streams of the seed,
+    //so a level is identical whether it was generated on its own or as part of a full build,
+    //and whatever the thread count or fern backend.
+    class BarnsleyFernGenerator : public AppendingGenerator
+    {
+    public:
+        explicit BarnsleyFernGenerator(std::uint64_t seed);
+
+        //Restarts the generator, so the next level is built in full from the new seed
+        void setSeed(std::uint64_t newSeed);
+        std::uint64_t getSeed() const { return seed; }
+
+        virtual void build(int numberOfIterations, std::vector<GeometryData>& objects);
+        virtual void buildNextLevel(GeometryAppend& append);
+
+        void buildDensity(int numberOfIterations, DensityHistogram& histogram);
+        void buildNextDensityLevel(DensityHistogram& histogram);
+
+    private:
+        std::uint64_t seed;
+    };
+}
+
+#endif /* GEOMETRYBUILDER_H_ */
@@ -0,0 +1,118 @@
+/*
+ * GpuBufferPool.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "GpuBufferPool.h"
+
+namespace {
+	//A pooled buffer is reused for a request if the request fills at least this fraction of it
+	const GLsizeiptr MINIMUM_FILL_DIVISOR = 2;
+
+	//Attribute locations the renderer's vaos use: position, colour, then the three columns of
+	//the instance transform and the instance colour offset
+	const GLuint VERTEX_ARRAY_ATTRIBUTES = 6;
+}
+
+GpuBufferPool::GpuBufferPool(std::size_t pooledByteBudget)
+	: pooledByteBudget(pooledByteBudget), pooledBytes(0), bytesInUse(0) {
+}
+
+GLuint GpuBufferPool::acquireBuffer(GLsizeiptr size) {
+	//Smallest pooled buffer that is big enough, if it is not too big
+	std::multimap<GLsizeiptr, GLuint>::iterator found = freeBuffers.lower_bound(size);
+	if (found != freeBuffers.end() && found->first <= size * MINIMUM_FILL_DIVISOR) {
+		GLuint buffer = found->second;
+		GLsizeiptr capacity = found->first;
+		pooledBytes -= capacity;
+		bytesInUse += capacity;
+		freeBuffers.erase(found);
+		//Orphaned, so draws still queued from its last owner don't hold up writes to it
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glBufferData(GL_ARRAY_BUFFER, capacity, 0, GL_STATIC_DRAW);
+		return buffer;
+	}
+
+	if (spareBufferNames.empty()) {
+		spareBufferNames.resize(NAME_BATCH_SIZE);
+		glGenBuffers(NAME_BATCH_SIZE, spareBufferNames.data());
+	}
+	GLuint buffer = spareBufferNames.back();
+	spareBufferNames.pop_back();
+
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, size, 0, GL_STATIC_DRAW);
+	capacities[buffer] = size;
+	bytesInUse += size;
+	return buffer;
+}
+
+void GpuBufferPool::releaseBuffer(GLuint buffer) {
+	std::unordered_map<GLuint, GLsizeiptr>::iterator found = capacities.find(buffer);
+	if (found == capacities.end()) {
+		if (buffer) {
+			glDeleteBuffers(1, &buffer);
+		}
+		return;
+	}
+
+	bytesInUse -= found->second;
+	pooledBytes += found->second;
+	freeBuffers.insert(std::make_pair(found->second, buffer));
+	trimToBudget();
+}
+
+GLsizeiptr GpuBufferPool::getCapacity(GLuint buffer) const {
+	std::unordered_map<GLuint, GLsizeiptr>::const_iterator found = capacities.find(buffer);
+	return (found != capacities.end()) ? found->second : 0;
+}
+
+GLuint GpuBufferPool::acquireVertexArray() {
+	if (spareVertexArrays.empty()) {
+		spareVertexArrays.resize(NAME_BATCH_SIZE);
+		glGenVertexArrays(NAME_BATCH_SIZE, spareVertexArrays.data());
+	}
+	GLuint vao = spareVertexArrays.back();
+	spareVertexArrays.pop_back();
+	return vao;
+}
+
+//A vao keeps the buffers its attributes point at alive, even after they are deleted, so a
+//pooled one would stop trimToBudget and clear from freeing anything. Its attributes are reset
+//to point at no buffer before it is kept.
+void GpuBufferPool::releaseVertexArray(GLuint vao) {
+	if (!vao) {
+		return;
+	}
+
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	for (GLuint attribute = 0; attribute < VERTEX_ARRAY_ATTRIBUTES; attribute++) {
+		glDisableVertexAttribArray(attribute);
+		glVertexAttribDivisor(attribute, 0);
+		glVertexAttribPointer(attribute, 4, GL_FLOAT, GL_FALSE, 0, 0);
+	}
+	glBindVertexArray(0);
+	spareVertexArrays.push_back(vao);
+}
+
+void GpuBufferPool::clear() {
+	for (std::multimap<GLsizeiptr, GLuint>::iterator i = freeBuffers.begin(); i != freeBuffers.end(); ++i) {
+		capacities.erase(i->second);
+		glDeleteBuffers(1, &i->second);
+	}
+	freeBuffers.clear();
+	pooledBytes = 0;
+}
+
+void GpuBufferPool::trimToBudget() {
+	//Largest first, as those are the least likely to fit a later request
+	while (pooledBytes > pooledByteBudget && !freeBuffers.empty()) {
+		std::multimap<GLsizeiptr, GLuint>::iterator largest = --freeBuffers.end();
+		pooledBytes -= largest->first;
+		capacities.erase(largest->second);
+		glDeleteBuffers(1, &largest->second);
+		freeBuffers.erase(largest);
+	}
+}
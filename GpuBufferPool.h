@@ -0,0 +1,67 @@
+/*
+ * GpuBufferPool.h
+ *	Owns the vbo and vao names of the scene geometry. Released buffers are kept, up to a
+ *	byte budget, and handed out again for later uploads of a similar size, so stepping
+ *	through levels neither leaks GPU memory nor reallocates it on every step.
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef GPUBUFFERPOOL_H_
+#define GPUBUFFERPOOL_H_
+
+#include <cstddef>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+//**Must include glad and GLFW in this order or it breaks**
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+class GpuBufferPool {
+public:
+	explicit GpuBufferPool(std::size_t pooledByteBudget);
+
+	//A buffer with storage for at least size bytes, left bound to GL_ARRAY_BUFFER: a pooled one
+	//if one is big enough without wasting much of it, otherwise a new one
+	GLuint acquireBuffer(GLsizeiptr size);
+	//Returns the buffer to the pool, deleting the largest pooled buffers if it goes over budget
+	void releaseBuffer(GLuint buffer);
+	//Bytes of storage the buffer has (0 for buffers the pool does not own)
+	GLsizeiptr getCapacity(GLuint buffer) const;
+
+	GLuint acquireVertexArray();
+	//Detaches the vao from its buffers and keeps it for reuse
+	void releaseVertexArray(GLuint vao);
+
+	//Deletes everything pooled, leaving buffers in use alone
+	void clear();
+
+	//Storage of the buffers in use and of those pooled for reuse
+	std::size_t getBytesInUse() const { return bytesInUse; }
+	std::size_t getPooledBytes() const { return pooledBytes; }
+	//Number of buffers in use and pooled
+	std::size_t getBufferCount() const { return capacities.size() - freeBuffers.size(); }
+	std::size_t getPooledBufferCount() const { return freeBuffers.size(); }
+
+private:
+	//Names are generated this many at a time
+	static const GLsizei NAME_BATCH_SIZE = 64;
+
+	void trimToBudget();
+
+	std::size_t pooledByteBudget;
+	std::size_t pooledBytes;
+	std::size_t bytesInUse;
+
+	//Storage size of every buffer the pool has allocated
+	std::unordered_map<GLuint, GLsizeiptr> capacities;
+	//Released buffers, by storage size
+	std::multimap<GLsizeiptr, GLuint> freeBuffers;
+
+	//Generated names that have no storage yet
+	std::vector<GLuint> spareBufferNames;
+	std::vector<GLuint> spareVertexArrays;
+};
+
+#endif /* GPUBUFFERPOOL_H_ */
@@ -0,0 +1,62 @@
+/*
+ * GpuTimer.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "GpuTimer.h"
+
+GpuTimer::GpuTimer() : freeQueries(QUERY_COUNT), activeQuery(0) {
+	glGenQueries(QUERY_COUNT, freeQueries.data());
+}
+
+GpuTimer::~GpuTimer() {
+	if (activeQuery) {
+		glEndQuery(GL_TIME_ELAPSED);
+		freeQueries.push_back(activeQuery);
+	}
+	freeQueries.insert(freeQueries.end(), pendingQueries.begin(), pendingQueries.end());
+	glDeleteQueries(freeQueries.size(), freeQueries.data());
+}
+
+void GpuTimer::begin() {
+	if (activeQuery || freeQueries.empty()) {
+		return;
+	}
+
+	activeQuery = freeQueries.back();
+	freeQueries.pop_back();
+	glBeginQuery(GL_TIME_ELAPSED, activeQuery);
+}
+
+void GpuTimer::end() {
+	if (!activeQuery) {
+		return;
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+	pendingQueries.push_back(activeQuery);
+	activeQuery = 0;
+}
+
+bool GpuTimer::takeResult(double& seconds) {
+	if (pendingQueries.empty()) {
+		return false;
+	}
+
+	//Results become available in the order the queries ended
+	GLuint query = pendingQueries.front();
+	GLint available = 0;
+	glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available) {
+		return false;
+	}
+
+	GLuint64 nanoseconds = 0;
+	glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+	pendingQueries.pop_front();
+	freeQueries.push_back(query);
+
+	seconds = nanoseconds * 1e-9;
+	return true;
+}
@@ -0,0 +1,41 @@
+/*
+ * GpuTimer.h
+ *	Measures the GPU time of a span of GL commands with GL_TIME_ELAPSED queries. Queries are
+ *	read back only once their results are available, a few frames later, so timing never
+ *	stalls the pipeline.
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef GPUTIMER_H_
+#define GPUTIMER_H_
+
+#include <deque>
+#include <vector>
+
+//**Must include glad and GLFW in this order or it breaks**
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+class GpuTimer {
+public:
+	GpuTimer();
+	~GpuTimer();
+
+	//Brackets the commands to time. If every query is still waiting for its result the span
+	//goes untimed rather than waiting for one.
+	void begin();
+	void end();
+
+	//Takes the result of the oldest finished span, in seconds, if there is one
+	bool takeResult(double& seconds);
+
+	//Spans that can be waiting for results at once
+	static const int QUERY_COUNT = 4;
+
+private:
+	std::vector<GLuint> freeQueries;
+	std::deque<GLuint> pendingQueries;
+	GLuint activeQuery;
+};
+
+#endif /* GPUTIMER_H_ */
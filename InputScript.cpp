@@ -0,0 +1,53 @@
+/*
+ * InputScript.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "InputScript.h"
+
+#include <fstream>
+#include <sstream>
+
+void InputScript::add(double time, int key, int scancode, int action, int mods) {
+	KeyEvent event = { time, key, scancode, action, mods };
+	events.push_back(event);
+}
+
+bool InputScript::load(const std::string& path) {
+	std::ifstream in(path.c_str());
+	if (!in.is_open()) {
+		return false;
+	}
+
+	events.clear();
+	std::string line;
+	while (std::getline(in, line)) {
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+
+		std::istringstream fields(line);
+		KeyEvent event;
+		if (!(fields >> event.time >> event.key >> event.scancode >> event.action >> event.mods)) {
+			return false;
+		}
+		events.push_back(event);
+	}
+	return true;
+}
+
+bool InputScript::save(const std::string& path) const {
+	std::ofstream out(path.c_str());
+	if (!out.is_open()) {
+		return false;
+	}
+
+	out.precision(6);
+	out << std::fixed << "# seconds key scancode action mods" << std::endl;
+	for (const KeyEvent& event : events) {
+		out << event.time << " " << event.key << " " << event.scancode << " " << event.action << " "
+			<< event.mods << std::endl;
+	}
+	return out.good();
+}
@@ -0,0 +1,36 @@
+/*
+ * InputScript.h
+ *	Key presses recorded from a session, with when they happened, so the session can be
+ *	replayed. Saved as text: a comment header, then one "seconds key scancode action mods"
+ *	line per event.
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INPUTSCRIPT_H_
+#define INPUTSCRIPT_H_
+
+#include <string>
+#include <vector>
+
+class InputScript {
+public:
+	struct KeyEvent {
+		//Seconds since recording started
+		double time;
+		int key;
+		int scancode;
+		int action;
+		int mods;
+	};
+
+	void add(double time, int key, int scancode, int action, int mods);
+	const std::vector<KeyEvent>& getEvents() const { return events; }
+
+	bool load(const std::string& path);
+	bool save(const std::string& path) const;
+
+private:
+	std::vector<KeyEvent> events;
+};
+
+#endif /* INPUTSCRIPT_H_ */
@@ -0,0 +1,257 @@
+/*
+ * LevelCache.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "LevelCache.h"
+
+#include <functional>
+#include <iterator>
+
+namespace
+{
+    std::size_t getDataByteSize(const GeometryData& data)
+    {
+        return (data.verts.size() + data.colors.size()) * sizeof(glm::vec3);
+    }
+}
+
+void GeneratedLevel::addObjects(std::vector<GeometryData>& generated)
+{
+    for (GeometryData& data : generated)
+    {
+        std::shared_ptr<GeometryData> part = std::make_shared<GeometryData>();
+        part->verts.swap(data.verts);
+        part->colors.swap(data.colors);
+        part->primitive = data.primitive;
+
+        LevelPart levelPart = { part, false };
+        parts.push_back(levelPart);
+    }
+    generated.clear();
+}
+
+std::size_t GeneratedLevel::getByteSize() const
+{
+    std::vector<std::pair<const void*, std::size_t> > buffers;
+    getBuffers(buffers);
+    std::size_t bytes = 0;
+    for (const std::pair<const void*, std::size_t>& buffer : buffers)
+    {
+        bytes += buffer.second;
+    }
+    return bytes;
+}
+
+void GeneratedLevel::getBuffers(std::vector<std::pair<const void*, std::size_t> >& buffers) const
+{
+    std::size_t instancedBytes = getDataByteSize(instanced.base) + instanced.transforms.size() * sizeof(glm::mat3) +
+        instanced.colourOffsets.size() * sizeof(glm::vec3);
+    if (instancedBytes > 0)
+    {
+        buffers.push_back(std::make_pair(static_cast<const void*>(&instanced), instancedBytes));
+    }
+    for (const LevelPart& part : parts)
+    {
+        buffers.push_back(std::make_pair(static_cast<const void*>(part.data.get()), getDataByteSize(*part.data)));
+    }
+    if (density)
+    {
+        buffers.push_back(std::make_pair(static_cast<const void*>(density.get()), density->getByteSize()));
+    }
+}
+
+bool LevelKey::operator==(const LevelKey& other) const
+{
+    return level == other.level && scene == other.scene && parameters == other.parameters;
+}
+
+std::size_t LevelCache::KeyHash::operator()(const LevelKey& key) const
+{
+    std::size_t hash = std::hash<std::string>()(key.scene);
+    hash = hash * 31 + std::hash<int>()(key.level);
+    hash = hash * 31 + std::hash<std::string>()(key.parameters);
+    return hash;
+}
+
+LevelCache::LevelCache(std::size_t byteBudget)
+: byteBudget(byteBudget), byteSize(0)
+{
+}
+
+std::shared_ptr<const GeneratedLevel> LevelCache::find(const LevelKey& key)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = index.find(key);
+    if (found == index.end())
+    {
+        return std::shared_ptr<const GeneratedLevel>();
+    }
+
+    //Move to the front without invalidating the iterator held by the index
+    entries.splice(entries.begin(), entries, found->second);
+    return found->second->level;
+}
+
+void LevelCache::insert(const LevelKey& key, const std::shared_ptr<const GeneratedLevel>& level)
+{
+    std::size_t levelByteSize = level->getByteSize();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = index.find(key);
+    if (found != index.end())
+    {
+        removeEntry(found->second);
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.level = level;
+    entry.byteSize = levelByteSize;
+    if (entry.byteSize > byteBudget)
+    {
+        return;
+    }
+
+    entries.push_front(entry);
+    index[key] = entries.begin();
+    byteSize += addBuffers(*level);
+    evictToBudget();
+}
+
+bool LevelCache::insertIfRoom(const LevelKey& key, const std::shared_ptr<const GeneratedLevel>& level)
+{
+    std::size_t levelByteSize = level->getByteSize();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (index.count(key) || byteSize + getAddedByteSize(*level) > byteBudget)
+    {
+        return false;
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.level = level;
+    entry.byteSize = levelByteSize;
+    entries.push_front(entry);
+    index[key] = entries.begin();
+    byteSize += addBuffers(*level);
+    return true;
+}
+
+bool LevelCache::contains(const LevelKey& key) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return index.count(key) != 0;
+}
+
+bool LevelCache::holdsBuffer(const void* buffer) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return bufferUses.count(buffer) != 0;
+}
+
+void LevelCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    bufferUses.clear();
+    byteSize = 0;
+}
+
+void LevelCache::setByteBudget(std::size_t newByteBudget)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    byteBudget = newByteBudget;
+    evictToBudget();
+}
+
+std::size_t LevelCache::getByteBudget() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return byteBudget;
+}
+
+std::size_t LevelCache::getByteSize() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return byteSize;
+}
+
+std::vector<std::pair<LevelKey, std::size_t> > LevelCache::getEntrySizes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::pair<LevelKey, std::size_t> > sizes;
+    sizes.reserve(entries.size());
+    for (const Entry& entry : entries)
+    {
+        sizes.push_back(std::make_pair(entry.key, entry.byteSize));
+    }
+    return sizes;
+}
+
+void LevelCache::evictToBudget()
+{
+    while (byteSize > byteBudget && !entries.empty())
+    {
+        removeEntry(std::prev(entries.end()));
+    }
+}
+
+void LevelCache::removeEntry(std::list<Entry>::iterator entry)
+{
+    byteSize -= removeBuffers(*entry->level);
+    index.erase(entry->key);
+    entries.erase(entry);
+}
+
+std::size_t LevelCache::addBuffers(const GeneratedLevel& level)
+{
+    std::vector<std::pair<const void*, std::size_t> > buffers;
+    level.getBuffers(buffers);
+    std::size_t addedBytes = 0;
+    for (const std::pair<const void*, std::size_t>& buffer : buffers)
+    {
+        BufferUse& use = bufferUses[buffer.first];
+        if (use.levels++ == 0)
+        {
+            use.byteSize = buffer.second;
+            addedBytes += buffer.second;
+        }
+    }
+    return addedBytes;
+}
+
+std::size_t LevelCache::removeBuffers(const GeneratedLevel& level)
+{
+    std::vector<std::pair<const void*, std::size_t> > buffers;
+    level.getBuffers(buffers);
+    std::size_t removedBytes = 0;
+    for (const std::pair<const void*, std::size_t>& buffer : buffers)
+    {
+        auto use = bufferUses.find(buffer.first);
+        if (use != bufferUses.end() && --use->second.levels == 0)
+        {
+            removedBytes += use->second.byteSize;
+            bufferUses.erase(use);
+        }
+    }
+    return removedBytes;
+}
+
+std::size_t LevelCache::getAddedByteSize(const GeneratedLevel& level) const
+{
+    std::vector<std::pair<const void*, std::size_t> > buffers;
+    level.getBuffers(buffers);
+    std::size_t addedBytes = 0;
+    for (const std::pair<const void*, std::size_t>& buffer : buffers)
+    {
+        if (!bufferUses.count(buffer.first))
+        {
+            addedBytes += buffer.second;
+        }
+    }
+    return addedBytes;
+}
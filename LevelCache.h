@@ -0,0 +1,136 @@
+/*
+ * LevelCache.h
+ *	Least-recently-used cache of generated scene levels, kept under a byte budget
+ *	so recently viewed levels can be shown again without regenerating them. Safe to use from
+ *	the render and generation threads at once.
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef LEVELCACHE_H_
+#define LEVELCACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "DensityHistogram.h"
+#include "GeometryBuilder.h"
+
+//A run of vertices of one object. A level stepped up from the one below shares that level's
+//parts and adds its own after them, so the step only stores what it adds.
+struct LevelPart
+{
+    std::shared_ptr<const GeometryData> data;
+    //Whether the vertices carry on the object of the part before, rather than starting a new one
+    bool continuesObject;
+};
+
+//Everything one scene level displays
+struct GeneratedLevel
+{
+    //Moves freshly generated objects into parts of their own, leaving `generated` empty
+    void addObjects(std::vector<GeometryData>& generated);
+
+    //Plain objects (drawn on top of the instanced base, if any)
+    std::vector<LevelPart> parts;
+    //Used when it has transforms
+    InstancedGeometryData instanced;
+    //Set, instead of parts, for density levels
+    std::shared_ptr<DensityHistogram> density;
+
+    //CPU memory held by the level's buffers, including parts shared with other levels
+    std::size_t getByteSize() const;
+
+    //Every buffer the level holds and its size, so buffers shared between levels can be counted once
+    void getBuffers(std::vector<std::pair<const void*, std::size_t> >& buffers) const;
+};
+
+//Which level of which scene, and the settings it was generated with
+struct LevelKey
+{
+    LevelKey() : level(0) {}
+
+    std::string scene;
+    int level;
+    //Everything else the level depends on (display mode, seed, screen scale), as text
+    std::string parameters;
+
+    bool operator==(const LevelKey& other) const;
+};
+
+class LevelCache
+{
+public:
+    explicit LevelCache(std::size_t byteBudget);
+
+    //The cached level, now the most recently used, or null
+    std::shared_ptr<const GeneratedLevel> find(const LevelKey& key);
+
+    //Adds or replaces a level, then evicts the least recently used levels until the cache is
+    //back under budget. A level larger than the whole budget is not kept. Parts shared between
+    //cached levels only count against the budget once.
+    void insert(const LevelKey& key, const std::shared_ptr<const GeneratedLevel>& level);
+
+    //Adds a level only if it fits without evicting anything, for levels nobody has asked for yet.
+    //Returns whether it was added.
+    bool insertIfRoom(const LevelKey& key, const std::shared_ptr<const GeneratedLevel>& level);
+
+    //Whether the level is cached, without counting as a use
+    bool contains(const LevelKey& key) const;
+    //Whether a cached level holds the buffer (a part's data, as getBuffers names it)
+    bool holdsBuffer(const void* buffer) const;
+
+    void clear();
+
+    void setByteBudget(std::size_t newByteBudget);
+    std::size_t getByteBudget() const;
+    std::size_t getByteSize() const;
+
+    //Key and byte size of every cached level, most recently used first (parts shared between
+    //levels are counted in each)
+    std::vector<std::pair<LevelKey, std::size_t> > getEntrySizes() const;
+
+private:
+    struct Entry
+    {
+        LevelKey key;
+        std::shared_ptr<const GeneratedLevel> level;
+        std::size_t byteSize;
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const LevelKey& key) const;
+    };
+
+    //How many cached levels hold a buffer, and its size
+    struct BufferUse
+    {
+        std::size_t levels;
+        std::size_t byteSize;
+    };
+
+    //Callers hold the mutex. Adding or removing a level's buffers returns the bytes the cache
+    //holds because of them alone.
+    void evictToBudget();
+    std::size_t addBuffers(const GeneratedLevel& level);
+    std::size_t removeBuffers(const GeneratedLevel& level);
+    std::size_t getAddedByteSize(const GeneratedLevel& level) const;
+    void removeEntry(std::list<Entry>::iterator entry);
+
+    mutable std::mutex mutex;
+    std::size_t byteBudget;
+    std::size_t byteSize;
+
+    //Most recently used first
+    std::list<Entry> entries;
+    std::unordered_map<LevelKey, std::list<Entry>::iterator, KeyHash> index;
+    std::unordered_map<const void*, BufferUse> bufferUses;
+};
+
+#endif /* LEVELCACHE_H_ */
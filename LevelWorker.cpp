@@ -0,0 +1,187 @@
+/*
+ * LevelWorker.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "LevelWorker.h"
+#include "Profiler.h"
+#include "ThreadTools.h"
+
+#include <chrono>
+#include <iostream>
+#include <new>
+
+LevelWorker::LevelWorker()
+: stopping(false), queued(false), running(false), runningCancelled(false), runningPrefetch(false), cancelRunning(false),
+  finished(false),
+  finishedSeconds(0.0), thread(&LevelWorker::run, this)
+{
+}
+
+LevelWorker::~LevelWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        queued = false;
+        queuedJob = Job();
+        prefetches.clear();
+    }
+    wake.notify_all();
+    thread.join();
+}
+
+void LevelWorker::submit(const LevelKey& key, const Job& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = false;
+        finishedLevel.reset();
+        prefetches.clear();
+
+        if (running && runningKey == key && !runningCancelled)
+        {
+            //Already on its way: coalesce with the running job. One already cancelled may have
+            //stopped part way, so it cannot be taken back.
+            runningPrefetch = false;
+            queued = false;
+            queuedJob = Job();
+            return;
+        }
+
+        cancelRunningJob();
+        queued = true;
+        queuedKey = key;
+        queuedJob = job;
+    }
+    wake.notify_one();
+}
+
+void LevelWorker::cancel()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    queued = false;
+    queuedJob = Job();
+    prefetches.clear();
+    cancelRunningJob();
+    finished = false;
+    finishedLevel.reset();
+}
+
+void LevelWorker::cancelRunningJob()
+{
+    if (running)
+    {
+        runningCancelled = true;
+        cancelRunning = true;
+    }
+}
+
+void LevelWorker::prefetch(const LevelKey& key, const Job& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        prefetches.push_back(std::make_pair(key, job));
+    }
+    wake.notify_one();
+}
+
+bool LevelWorker::takeFinished(LevelKey& key, std::shared_ptr<const GeneratedLevel>& level, double& seconds)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!finished)
+    {
+        return false;
+    }
+
+    key = finishedKey;
+    seconds = finishedSeconds;
+    level.swap(finishedLevel);
+    finishedLevel.reset();
+    finished = false;
+    return true;
+}
+
+bool LevelWorker::isBusy() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return queued || running || !prefetches.empty();
+}
+
+void LevelWorker::setJobDoneCallback(const std::function<void()>& callback)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    jobDoneCallback = callback;
+}
+
+void LevelWorker::run()
+{
+    Profiler::setThreadName("level worker");
+    ThreadTools::CancelScope cancelScope(&cancelRunning);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, [this] { return stopping || queued || !prefetches.empty(); });
+        if (stopping)
+        {
+            return;
+        }
+
+        Job job;
+        if (queued)
+        {
+            job.swap(queuedJob);
+            queued = false;
+            runningKey = queuedKey;
+            runningPrefetch = false;
+        }
+        else
+        {
+            job.swap(prefetches.front().second);
+            runningKey = prefetches.front().first;
+            prefetches.pop_front();
+            runningPrefetch = true;
+        }
+        running = true;
+        runningCancelled = false;
+        cancelRunning = false;
+
+        lock.unlock();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::shared_ptr<const GeneratedLevel> level;
+        try
+        {
+            level = job();
+        }
+        catch (const std::bad_alloc&)
+        {
+            std::cout << "Not enough memory to generate level " << runningKey.level << std::endl;
+        }
+        catch (const ThreadTools::Cancelled&)
+        {
+            //Superseded by real input; nothing of it was cached
+        }
+        //Let go of whatever the job holds before taking the lock again
+        job = Job();
+        std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+        lock.lock();
+
+        running = false;
+        if (!runningCancelled && !runningPrefetch && level)
+        {
+            finished = true;
+            finishedKey = runningKey;
+            finishedLevel = level;
+            finishedSeconds = seconds.count();
+        }
+
+        if (jobDoneCallback)
+        {
+            std::function<void()> callback = jobDoneCallback;
+            lock.unlock();
+            callback();
+            lock.lock();
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ * LevelWorker.h
+ *	Background thread that generates scene levels, so input and repainting never wait
+ *	on generation. Only the latest requested level is worked towards; speculative
+ *	prefetches fill in the idle time.
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef LEVELWORKER_H_
+#define LEVELWORKER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "LevelCache.h"
+
+class LevelWorker
+{
+public:
+    //Runs on the worker thread; returns the generated level, or null if there is nothing to show
+    typedef std::function<std::shared_ptr<const GeneratedLevel>()> Job;
+
+    LevelWorker();
+    //Drops the queued job and waits for the running one
+    ~LevelWorker();
+
+    //Makes job the next to run, replacing any job still queued and dropping all prefetches. If a
+    //job for another level is running it is cancelled, stopping at its next cancellation point
+    //(see ThreadTools::CancelScope); if one for the same level is running, prefetch or not, that
+    //one is kept instead.
+    void submit(const LevelKey& key, const Job& job);
+
+    //Drops the queued job and all prefetches, and cancels the running job
+    void cancel();
+
+    //Queues a job to run once nothing else is queued, after any prefetches already queued.
+    //Its result is never reported: the job is expected to cache what it generates.
+    void prefetch(const LevelKey& key, const Job& job);
+
+    //Takes the level of the last job that finished without being cancelled, if there is one,
+    //and how many seconds the job ran for
+    bool takeFinished(LevelKey& key, std::shared_ptr<const GeneratedLevel>& level, double& seconds);
+
+    //Whether a job or prefetch is queued or running
+    bool isBusy() const;
+
+    //Called on the worker thread after every job, prefetch or not, so a main loop blocked
+    //waiting for events can be woken to look for the result
+    void setJobDoneCallback(const std::function<void()>& callback);
+
+private:
+    void run();
+    //Callers hold the mutex
+    void cancelRunningJob();
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    bool queued;
+    LevelKey queuedKey;
+    Job queuedJob;
+
+    //Lowest priority, oldest first
+    std::deque<std::pair<LevelKey, Job> > prefetches;
+
+    bool running;
+    bool runningCancelled;
+    bool runningPrefetch;
+    //Set along with runningCancelled, for the running job to poll without the lock
+    std::atomic<bool> cancelRunning;
+    LevelKey runningKey;
+
+    bool finished;
+    LevelKey finishedKey;
+    std::shared_ptr<const GeneratedLevel> finishedLevel;
+    double finishedSeconds;
+
+    std::function<void()> jobDoneCallback;
+
+    //Started last, once everything it reads is initialised
+    std::thread thread;
+};
+
+#endif /* LEVELWORKER_H_ */
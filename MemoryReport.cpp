@@ -0,0 +1,85 @@
+/*
+ * MemoryReport.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "MemoryReport.h"
+
+#include <iomanip>
+
+namespace {
+	const char* SECTION_HEADINGS[] = { "By category", "Displayed objects", "Cached levels" };
+	const int SECTION_COUNT = 3;
+
+	//Bytes as KiB with one decimal, which keeps small buffers and whole levels readable
+	void printBytes(std::ostream& out, std::size_t bytes) {
+		out << std::setw(12) << std::fixed << std::setprecision(1) << bytes / 1024.0 << " KiB";
+	}
+
+	void printEntry(std::ostream& out, const std::string& name, std::size_t cpuBytes, std::size_t gpuBytes,
+		std::size_t count) {
+		out << "  " << std::left << std::setw(52) << name << std::right << " cpu";
+		printBytes(out, cpuBytes);
+		out << "  gpu";
+		printBytes(out, gpuBytes);
+		out << "  x" << count << std::endl;
+	}
+}
+
+MemoryReport::MemoryReport(const std::string& title) : title(title) {
+}
+
+void MemoryReport::add(Section section, const std::string& name, std::size_t cpuBytes, std::size_t gpuBytes,
+	std::size_t count) {
+	Entry entry = { section, name, cpuBytes, gpuBytes, count };
+	entries.push_back(entry);
+}
+
+std::size_t MemoryReport::getCpuBytes() const {
+	std::size_t bytes = 0;
+	for (const Entry& entry : entries) {
+		if (entry.section == CATEGORY) {
+			bytes += entry.cpuBytes;
+		}
+	}
+	return bytes;
+}
+
+std::size_t MemoryReport::getGpuBytes() const {
+	std::size_t bytes = 0;
+	for (const Entry& entry : entries) {
+		if (entry.section == CATEGORY) {
+			bytes += entry.gpuBytes;
+		}
+	}
+	return bytes;
+}
+
+void MemoryReport::print(std::ostream& out) const {
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+
+	out << "Memory: " << title << std::endl;
+	for (int section = 0; section < SECTION_COUNT; section++) {
+		bool printedHeading = false;
+		for (const Entry& entry : entries) {
+			if (entry.section != section) {
+				continue;
+			}
+			if (!printedHeading) {
+				out << SECTION_HEADINGS[section] << std::endl;
+				printedHeading = true;
+			}
+			printEntry(out, entry.name, entry.cpuBytes, entry.gpuBytes, entry.count);
+		}
+	}
+	out << "Total cpu";
+	printBytes(out, getCpuBytes());
+	out << "  gpu";
+	printBytes(out, getGpuBytes());
+	out << std::endl;
+
+	out.flags(flags);
+	out.precision(precision);
+}
@@ -0,0 +1,51 @@
+/*
+ * MemoryReport.h
+ *	Snapshot of the CPU and GPU memory a scene holds: per object, per kind of buffer
+ *	and per cached level.
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef MEMORYREPORT_H_
+#define MEMORYREPORT_H_
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class MemoryReport {
+public:
+	//Categories partition everything the report covers and are what the totals add up.
+	//Objects and cached levels break parts of them down further.
+	enum Section {
+		CATEGORY,
+		OBJECT,
+		CACHED_LEVEL
+	};
+
+	struct Entry {
+		Section section;
+		std::string name;
+		std::size_t cpuBytes;
+		std::size_t gpuBytes;
+		//Objects, buffers or textures the entry covers
+		std::size_t count;
+	};
+
+	explicit MemoryReport(const std::string& title);
+
+	void add(Section section, const std::string& name, std::size_t cpuBytes, std::size_t gpuBytes, std::size_t count);
+
+	const std::string& getTitle() const { return title; }
+	const std::vector<Entry>& getEntries() const { return entries; }
+	std::size_t getCpuBytes() const;
+	std::size_t getGpuBytes() const;
+
+	void print(std::ostream& out) const;
+
+private:
+	std::string title;
+	std::vector<Entry> entries;
+};
+
+#endif /* MEMORYREPORT_H_ */
@@ -0,0 +1,218 @@
+/*
+ * Profiler.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "Profiler.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Profiler::enabled(false);
+
+namespace {
+	struct Event {
+		const char* name;
+		std::uint64_t start;
+		std::uint64_t duration;
+	};
+
+	//Events are stored in chunks allocated as a buffer fills, so readers never see them move
+	const std::size_t CHUNK_EVENTS = 4096;
+	const std::size_t MAX_CHUNKS = 256;
+
+	//Written only by the thread that owns it. A buffer outlives its thread, so its zones can
+	//still be exported, and is handed on to the next new thread, along with its thread id, to
+	//keep memory and the thread list bounded.
+	struct ThreadBuffer {
+		explicit ThreadBuffer(unsigned int thread) : thread(thread), chunks(), count(0), session(0), dropped(0) {}
+
+		//Index into the registry's thread names and the tid of every event in the buffer
+		const unsigned int thread;
+		std::atomic<Event*> chunks[MAX_CHUNKS];
+		//Events published to readers, stored with release once an event is written
+		std::atomic<std::size_t> count;
+		//Recording the events belong to; a buffer from an older one is emptied before reuse
+		std::atomic<unsigned int> session;
+		std::atomic<std::size_t> dropped;
+	};
+
+	struct Registry {
+		std::mutex mutex;
+		std::vector<ThreadBuffer*> buffers;
+		std::vector<ThreadBuffer*> unownedBuffers;
+		//One per buffer, indexed by its thread id
+		std::vector<std::string> threadNames;
+	};
+
+	std::atomic<unsigned int> currentSession(0);
+
+	const std::chrono::steady_clock::time_point EPOCH = std::chrono::steady_clock::now();
+
+	//Never destroyed, as threads may still record while the program exits
+	Registry& getRegistry() {
+		static Registry* registry = new Registry();
+		return *registry;
+	}
+
+	//Gives the calling thread its buffer, and the buffer's id, for as long as it runs
+	struct ThreadSlot {
+		ThreadSlot() : buffer(0) {
+			Registry& registry = getRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			if (!registry.unownedBuffers.empty()) {
+				buffer = registry.unownedBuffers.back();
+				registry.unownedBuffers.pop_back();
+				//The previous owner's name would mislabel this thread
+				registry.threadNames[buffer->thread].clear();
+			} else {
+				buffer = new ThreadBuffer(registry.buffers.size());
+				registry.buffers.push_back(buffer);
+				registry.threadNames.push_back(std::string());
+			}
+		}
+
+		~ThreadSlot() {
+			Registry& registry = getRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			registry.unownedBuffers.push_back(buffer);
+		}
+
+		ThreadBuffer* buffer;
+	};
+
+	ThreadSlot& getThreadSlot() {
+		thread_local ThreadSlot slot;
+		return slot;
+	}
+
+	//Writes text as a JSON string
+	void writeString(std::ostream& out, const std::string& text) {
+		out << '"';
+		for (char c : text) {
+			if (c == '"' || c == '\\') {
+				out << '\\' << c;
+			} else if ((unsigned char)c < 0x20) {
+				char escaped[8];
+				std::snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)c);
+				out << escaped;
+			} else {
+				out << c;
+			}
+		}
+		out << '"';
+	}
+
+	void writeMicroseconds(std::ostream& out, std::uint64_t nanoseconds) {
+		out << nanoseconds / 1000 << '.';
+		char fraction[4];
+		std::snprintf(fraction, sizeof(fraction), "%03u", (unsigned int)(nanoseconds % 1000));
+		out << fraction;
+	}
+}
+
+void Profiler::setEnabled(bool enable) {
+	if (enable && !enabled.load()) {
+		currentSession.fetch_add(1);
+	}
+	enabled.store(enable);
+}
+
+std::uint64_t Profiler::now() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - EPOCH).count();
+}
+
+void Profiler::setThreadName(const char* name) {
+	ThreadSlot& slot = getThreadSlot();
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	registry.threadNames[slot.buffer->thread] = name;
+}
+
+void Profiler::record(const char* name, std::uint64_t start, std::uint64_t end) {
+	ThreadSlot& slot = getThreadSlot();
+	ThreadBuffer& buffer = *slot.buffer;
+
+	unsigned int session = currentSession.load(std::memory_order_relaxed);
+	if (buffer.session.load(std::memory_order_relaxed) != session) {
+		buffer.count.store(0, std::memory_order_relaxed);
+		buffer.dropped.store(0, std::memory_order_relaxed);
+		buffer.session.store(session, std::memory_order_release);
+	}
+
+	std::size_t index = buffer.count.load(std::memory_order_relaxed);
+	std::size_t chunk = index / CHUNK_EVENTS;
+	if (chunk >= MAX_CHUNKS) {
+		buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	Event* events = buffer.chunks[chunk].load(std::memory_order_relaxed);
+	if (!events) {
+		events = new Event[CHUNK_EVENTS];
+		buffer.chunks[chunk].store(events, std::memory_order_release);
+	}
+
+	Event& event = events[index % CHUNK_EVENTS];
+	event.name = name;
+	event.start = start;
+	event.duration = end - start;
+	buffer.count.store(index + 1, std::memory_order_release);
+}
+
+bool Profiler::exportTrace(const std::string& path) {
+	std::ofstream out(path.c_str());
+	if (!out.is_open()) {
+		return false;
+	}
+
+	Registry& registry = getRegistry();
+	std::vector<ThreadBuffer*> buffers;
+	std::vector<std::string> threadNames;
+	{
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		buffers = registry.buffers;
+		threadNames = registry.threadNames;
+	}
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+	for (std::size_t thread = 0; thread < threadNames.size(); thread++) {
+		if (threadNames[thread].empty()) {
+			continue;
+		}
+		out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread
+			<< ",\"args\":{\"name\":";
+		writeString(out, threadNames[thread]);
+		out << "}}";
+		first = false;
+	}
+
+	unsigned int session = currentSession.load();
+	std::size_t dropped = 0;
+	for (ThreadBuffer* buffer : buffers) {
+		if (buffer->session.load(std::memory_order_acquire) != session) {
+			continue;
+		}
+
+		std::size_t count = buffer->count.load(std::memory_order_acquire);
+		dropped += buffer->dropped.load(std::memory_order_relaxed);
+		for (std::size_t index = 0; index < count; index++) {
+			const Event& event = buffer->chunks[index / CHUNK_EVENTS].load(std::memory_order_acquire)[index % CHUNK_EVENTS];
+			out << (first ? "\n" : ",\n") << "{\"name\":";
+			writeString(out, event.name);
+			out << ",\"cat\":\"fractals\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread << ",\"ts\":";
+			writeMicroseconds(out, event.start);
+			out << ",\"dur\":";
+			writeMicroseconds(out, event.duration);
+			out << "}";
+			first = false;
+		}
+	}
+	out << "\n],\"otherData\":{\"droppedZones\":" << dropped << "}}\n";
+	return out.good();
+}
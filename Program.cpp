@@ -7,6 +7,7 @@
 
 #include "Program.h"
 
+#include <fstream>
 #include <iostream>
 #include <string>
 
@@ -16,28 +17,345 @@
 
 #include "RenderingEngine.h"
 #include "Scene.h"
+#include "FernKernels.h"
+#include "GeometryBuilder.h"
+#include "GpuTimer.h"
+#include "Profiler.h"
 
-Program::Program() {
+namespace {
+	//Frame limits cycled through with F, in frames per second (0 leaves the rate to vsync)
+	const double FRAME_LIMITS[] = { 60.0, 30.0, 120.0, 0.0 };
+	const int FRAME_LIMIT_COUNT = sizeof(FRAME_LIMITS) / sizeof(FRAME_LIMITS[0]);
+
+	const char* WINDOW_TITLE = "CPSC 453 OpenGL Boilerplate";
+
+	//Frames the timing summaries are taken over, and where the timing log is written
+	const size_t FRAME_STATS_WINDOW = 240;
+	const char* FRAME_LOG_PATH = "frame_times.csv";
+
+	//Where recorded profiles are exported
+	const char* TRACE_PATH = "trace.json";
+
+	//A replay keeps the times of every frame, not just the recent ones
+	const size_t REPLAY_STATS_WINDOW = 65536;
+	//Longest a replayed key press may take to be shown before the replay moves on, and how
+	//often the replay checks on the worker while waiting
+	const double REPLAY_STEP_TIMEOUT = 120.0;
+	const double REPLAY_POLL_INTERVAL = 0.1;
+
+	void writeSummary(std::ostream& out, const FrameStats::Summary& summary) {
+		const double MILLISECONDS = 1000.0;
+		out << "{\"min\":" << summary.min * MILLISECONDS << ",\"avg\":" << summary.average * MILLISECONDS
+			<< ",\"median\":" << summary.median * MILLISECONDS << ",\"p99\":" << summary.p99 * MILLISECONDS << "}";
+	}
+}
+
+Program::Program(const ProgramOptions& options) : options(options), window(0), renderingEngine(0), scene(0), recordingStart(0.0),
+		redrawNeeded(true), presentNeeded(false), minimized(false), vsync(true), framePacer(FRAME_LIMITS[0]),
+		frameStats(options.replayPath.empty() ? FRAME_STATS_WINDOW : REPLAY_STATS_WINDOW), gpuTimer(0),
+		showingTimings(false) {
 	setupWindow();
 }
 
 Program::~Program() {
 	//Must be cleaned up in the destructor because these are allocated to the heap
+	delete gpuTimer;
 	delete renderingEngine;
 	delete scene;
 }
 
 void Program::start() {
+	if (!options.fernBackend.empty()) {
+		FernKernels::Backend backend = FernKernels::SCALAR_BACKEND;
+		FernKernels::getBackendByName(options.fernBackend.c_str(), backend);
+		GeometryBuilder::setFernBackend(backend);
+		std::cout << "Generating the fern with the " << FernKernels::getBackendName(GeometryBuilder::getFernBackend())
+			<< " kernel" << std::endl;
+	}
+
 	renderingEngine = new RenderingEngine();
-	scene = new Scene(renderingEngine);
+	if (options.softwareRendering) {
+		renderingEngine->setBackend(RenderingEngine::SOFTWARE_BACKEND);
+	}
+	scene = new Scene(renderingEngine, options.levelCacheMegabytes * 1024 * 1024);
+	scene->setPrefetching(options.replayPath.empty());
+	gpuTimer = new GpuTimer();
 
-	//Main render loop
+	//Wake the loop below when a level finishes generating while it waits for events
+	scene->setLevelDoneCallback(glfwPostEmptyEvent);
+	Profiler::setThreadName("main");
+
+	recordingStart = glfwGetTime();
+	if (!options.replayPath.empty()) {
+		replay();
+	} else {
+		runInteractive();
+	}
+
+	if (!options.recordPath.empty()) {
+		if (recording.save(options.recordPath)) {
+			std::cout << "Recorded " << recording.getEvents().size() << " key presses to " << options.recordPath << std::endl;
+		} else {
+			std::cout << "Could not write " << options.recordPath << std::endl;
+		}
+	}
+}
+
+void Program::runInteractive() {
+	//Main render loop: draws only when the scene has changed, and otherwise sleeps until
+	//something happens (input, an expose, a level finishing)
 	while(!glfwWindowShouldClose(window)) {
-		scene->displayScene();
-		glfwSwapBuffers(window);
-		glfwPollEvents();
+		{
+			PROFILE_ZONE("update");
+			if (scene->update()) {
+				redrawNeeded = true;
+			}
+		}
+
+		if ((redrawNeeded || presentNeeded) && !minimized) {
+			double wait = framePacer.getWaitTime(glfwGetTime());
+			if (wait > 0.0) {
+				PROFILE_ZONE("frame limit");
+				glfwWaitEventsTimeout(wait);
+				continue;
+			}
+			if (showFrame()) {
+				PROFILE_ZONE("poll events");
+				glfwPollEvents();
+			} else {
+				PROFILE_ZONE("wait for events");
+				glfwWaitEvents();
+			}
+		} else {
+			PROFILE_ZONE("wait for events");
+			glfwWaitEvents();
+		}
 	}
 
+}
+
+void Program::recordKey(int key, int scancode, int action, int mods) {
+	//Only presses do anything, so releases and repeats are left out
+	if (!options.recordPath.empty() && action == GLFW_PRESS) {
+		recording.add(glfwGetTime() - recordingStart, key, scancode, action, mods);
+	}
+}
+
+void Program::replay() {
+	InputScript script;
+	if (!script.load(options.replayPath)) {
+		std::cout << "Could not read input script " << options.replayPath << std::endl;
+		return;
+	}
+
+	//Frames go out as fast as they are drawn, so the times are the work and nothing else
+	vsync = false;
+	glfwSwapInterval(0);
+
+	int frames = 0;
+	if (!showRequestedLevel(frames)) {
+		std::cout << "The first level was not shown in time, stopping the replay" << std::endl;
+		return;
+	}
+
+	std::vector<double> latencies;
+	std::vector<int> framesPerStep;
+	std::vector<bool> settled;
+	const std::vector<InputScript::KeyEvent>& events = script.getEvents();
+	for (size_t i = 0; i < events.size() && !glfwWindowShouldClose(window); i++) {
+		const InputScript::KeyEvent& event = events[i];
+		double start = glfwGetTime();
+		KeyCallback(window, event.key, event.scancode, event.action, event.mods);
+
+		frames = 0;
+		settled.push_back(showRequestedLevel(frames));
+		latencies.push_back(glfwGetTime() - start);
+		framesPerStep.push_back(frames);
+	}
+
+	if (!writeReplayReport(script, latencies, framesPerStep, settled)) {
+		std::cout << "Could not write " << options.reportPath << std::endl;
+	}
+}
+
+bool Program::showRequestedLevel(int& frames) {
+	double start = glfwGetTime();
+	while (!glfwWindowShouldClose(window)) {
+		if (scene->update()) {
+			redrawNeeded = true;
+		}
+		if ((redrawNeeded || presentNeeded) && showFrame()) {
+			frames++;
+		}
+		if (scene->isLevelShown() && !redrawNeeded) {
+			return true;
+		}
+		if (glfwGetTime() - start > REPLAY_STEP_TIMEOUT) {
+			return false;
+		}
+		//Woken early when the worker finishes
+		glfwWaitEventsTimeout(REPLAY_POLL_INTERVAL);
+	}
+	return false;
+}
+
+bool Program::writeReplayReport(const InputScript& script, const std::vector<double>& latencies,
+	const std::vector<int>& framesPerStep, const std::vector<bool>& settled) {
+	std::ofstream file;
+	if (!options.reportPath.empty()) {
+		file.open(options.reportPath.c_str());
+		if (!file.is_open()) {
+			return false;
+		}
+	}
+	std::ostream& out = options.reportPath.empty() ? std::cout : file;
+
+	std::string renderer = reinterpret_cast<const char *>(glGetString(GL_RENDERER));
+	if (renderingEngine->getBackend() == RenderingEngine::SOFTWARE_BACKEND) {
+		renderer = "software rasterizer on " + renderer;
+	}
+	out << "{\"script\":\"" << options.replayPath << "\",\"renderer\":\"" << renderer << "\",\"steps\":[";
+	const std::vector<InputScript::KeyEvent>& events = script.getEvents();
+	for (size_t i = 0; i < latencies.size(); i++) {
+		out << (i ? ",\n" : "\n") << "{\"step\":" << i << ",\"key\":" << events[i].key << ",\"action\":"
+			<< events[i].action << ",\"recordedTime\":" << events[i].time << ",\"latencyMs\":"
+			<< latencies[i] * 1000.0 << ",\"frames\":" << framesPerStep[i] << ",\"settled\":"
+			<< (settled[i] ? "true" : "false") << "}";
+	}
+
+	out << "\n],\"latencyMs\":";
+	writeSummary(out, FrameStats::summarise(latencies));
+	out << ",\"frameMs\":{";
+	for (int stage = 0; stage < FrameStats::STAGE_COUNT; stage++) {
+		FrameStats::Stage frameStage = (FrameStats::Stage)stage;
+		out << (stage ? "," : "") << "\"" << FrameStats::getStageName(frameStage) << "\":";
+		writeSummary(out, frameStats.getSummary(frameStage));
+	}
+	out << "}}" << std::endl;
+	return out.good();
+}
+
+bool Program::showFrame() {
+	PROFILE_ZONE("frame");
+	int width = 0;
+	int height = 0;
+	glfwGetFramebufferSize(window, &width, &height);
+	if (width <= 0 || height <= 0) {
+		return false;
+	}
+
+	double submitStart = glfwGetTime();
+	gpuTimer->begin();
+	if (redrawNeeded || !renderingEngine->presentFrame(width, height)) {
+		renderingEngine->beginFrame(width, height);
+		scene->displayScene();
+		renderingEngine->endFrame();
+		renderingEngine->presentFrame(width, height);
+	}
+	gpuTimer->end();
+
+	double swapStart = glfwGetTime();
+	{
+		PROFILE_ZONE("swap");
+		glfwSwapBuffers(window);
+	}
+	double frameEnd = glfwGetTime();
+
+	framePacer.frameShown(frameEnd);
+	redrawNeeded = false;
+	presentNeeded = false;
+	recordFrameTimes(submitStart, swapStart, frameEnd);
+	return true;
+}
+
+void Program::recordFrameTimes(double submitStart, double swapStart, double frameEnd) {
+	double generationSeconds = 0.0;
+	double uploadSeconds = 0.0;
+	scene->takeLevelTimes(generationSeconds, uploadSeconds);
+	frameStats.record(FrameStats::GENERATE, generationSeconds);
+	frameStats.record(FrameStats::UPLOAD, uploadSeconds);
+	frameStats.record(FrameStats::SUBMIT, swapStart - submitStart);
+	frameStats.record(FrameStats::SWAP, frameEnd - swapStart);
+	frameStats.record(FrameStats::FRAME, uploadSeconds + frameEnd - submitStart);
+
+	//GPU times arrive a few frames late, each kept as a sample of its own
+	double gpuSeconds = 0.0;
+	while (gpuTimer->takeResult(gpuSeconds)) {
+		frameStats.recordGpu(gpuSeconds);
+	}
+	frameStats.endFrame();
+
+	if (showingTimings) {
+		std::string title = std::string(WINDOW_TITLE) + "  " + frameStats.getOverlayText();
+		glfwSetWindowTitle(window, title.c_str());
+	}
+}
+
+void Program::toggleTimingOverlay() {
+	showingTimings = !showingTimings;
+	if (showingTimings) {
+		glfwSetWindowTitle(window, (std::string(WINDOW_TITLE) + "  " + frameStats.getOverlayText()).c_str());
+	} else {
+		glfwSetWindowTitle(window, WINDOW_TITLE);
+	}
+}
+
+void Program::toggleProfiling() {
+	if (!Profiler::isEnabled()) {
+		Profiler::setEnabled(true);
+		std::cout << "Profiling started" << std::endl;
+		return;
+	}
+
+	Profiler::setEnabled(false);
+	if (Profiler::exportTrace(TRACE_PATH)) {
+		std::cout << "Profile written to " << TRACE_PATH << std::endl;
+	} else {
+		std::cout << "Could not write " << TRACE_PATH << std::endl;
+	}
+}
+
+void Program::toggleBackend() {
+	bool software = renderingEngine->getBackend() == RenderingEngine::OPENGL_BACKEND;
+	renderingEngine->setBackend(software ? RenderingEngine::SOFTWARE_BACKEND : RenderingEngine::OPENGL_BACKEND);
+	std::cout << "Drawing with " << (software ? "the software rasterizer" : "OpenGL") << std::endl;
+	requestRedraw();
+}
+
+void Program::toggleTimingLog() {
+	if (frameStats.isLogging()) {
+		frameStats.stopLog();
+		std::cout << "Stopped logging frame times" << std::endl;
+	} else if (frameStats.startLog(FRAME_LOG_PATH)) {
+		std::cout << "Logging frame times to " << FRAME_LOG_PATH << std::endl;
+	} else {
+		std::cout << "Could not open " << FRAME_LOG_PATH << std::endl;
+	}
+}
+
+void Program::setFocused(bool focused) {
+	framePacer.setBackground(!focused);
+}
+
+void Program::cycleFrameLimit() {
+	int next = 0;
+	while (next < FRAME_LIMIT_COUNT && FRAME_LIMITS[next] != framePacer.getFrameLimit()) {
+		next++;
+	}
+	next = (next + 1) % FRAME_LIMIT_COUNT;
+	framePacer.setFrameLimit(FRAME_LIMITS[next]);
+
+	if (FRAME_LIMITS[next] > 0.0) {
+		std::cout << "Frame limit " << FRAME_LIMITS[next] << " fps" << std::endl;
+	} else {
+		std::cout << "Frame limit off" << std::endl;
+	}
+}
+
+void Program::toggleVsync() {
+	vsync = !vsync;
+	glfwSwapInterval(vsync ? 1 : 0);
+	std::cout << "Vsync " << (vsync ? "on" : "off") << std::endl;
 }
 
 void Program::setupWindow() {
@@ -58,7 +376,19 @@ void Program::setupWindow() {
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 	int width = 512;
 	int height = 512;
-	window = glfwCreateWindow(width, height, "CPSC 453 OpenGL Boilerplate", 0, 0);
+	if (!options.replayPath.empty()) {
+		//Replays run hidden, on a software renderer if GLFW has one, so they need no GPU or display
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+		window = glfwCreateWindow(width, height, WINDOW_TITLE, 0, 0);
+		if (!window) {
+			std::cout << "No software GL context, replaying on the native one" << std::endl;
+			glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_NATIVE_CONTEXT_API);
+		}
+	}
+	if (!window) {
+		window = glfwCreateWindow(width, height, WINDOW_TITLE, 0, 0);
+	}
 	if (!window) {
 		std::cout << "Program failed to create GLFW window, TERMINATING" << std::endl;
 		glfwTerminate();
@@ -69,15 +399,22 @@ void Program::setupWindow() {
 	glfwSetWindowUserPointer(window, this);
 	//Set the custom function that tracks key presses
 	glfwSetKeyCallback(window, KeyCallback);
+	//And the ones that say when the window needs drawing, and how often
+	glfwSetWindowRefreshCallback(window, WindowRefreshCallback);
+	glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
+	glfwSetWindowFocusCallback(window, WindowFocusCallback);
+	glfwSetWindowIconifyCallback(window, WindowIconifyCallback);
 
 	//Bring the new window to the foreground (not strictly necessary but convenient)
 	glfwMakeContextCurrent(window);
 
 	//Intialize GLAD (finds appropriate OpenGL configuration for your system)
-	if (!gladLoadGL()) {
+	//through GLFW, so it finds the functions of whichever context was created
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
 		std::cout << "GLAD init failed" << std::endl;
 		return;
 	}
+	glfwSwapInterval(vsync ? 1 : 0);
 
 	//Query and print out information about our OpenGL environment
 	QueryGLVersion();
@@ -108,6 +445,7 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
 	}
 
 	Program* program = (Program*)glfwGetWindowUserPointer(window);
+	program->recordKey(key, scancode, action, mods);
 	if (key == GLFW_KEY_1 && action == GLFW_PRESS) {
 		program->getScene()->changeToNestedSquareScene();
 	}
@@ -126,10 +464,60 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
     if (key == GLFW_KEY_6 && action == GLFW_PRESS) {
         program->getScene()->changeToHilbertCurveScene();
     }
+    if (key == GLFW_KEY_D && action == GLFW_PRESS) {
+        program->getScene()->toggleDensityMode();
+    }
+    if (key == GLFW_KEY_I && action == GLFW_PRESS) {
+        program->getScene()->toggleInstancedMode();
+    }
+    if (key == GLFW_KEY_R && action == GLFW_PRESS) {
+        program->getScene()->reseedRandomScenes();
+    }
 	if (key == GLFW_KEY_UP && action == GLFW_PRESS) {
 		program->getScene()->iterationUp();
 	}
 	if (key == GLFW_KEY_DOWN && action == GLFW_PRESS) {
 		program->getScene()->iterationDown();
 	}
+    if (key == GLFW_KEY_F && action == GLFW_PRESS) {
+        program->cycleFrameLimit();
+    }
+    if (key == GLFW_KEY_V && action == GLFW_PRESS) {
+        program->toggleVsync();
+    }
+    if (key == GLFW_KEY_T && action == GLFW_PRESS) {
+        program->toggleTimingOverlay();
+    }
+    if (key == GLFW_KEY_C && action == GLFW_PRESS) {
+        program->toggleTimingLog();
+    }
+    if (key == GLFW_KEY_P && action == GLFW_PRESS) {
+        program->toggleProfiling();
+    }
+    if (key == GLFW_KEY_M && action == GLFW_PRESS) {
+        program->getScene()->printMemoryReport();
+    }
+    if (key == GLFW_KEY_B && action == GLFW_PRESS) {
+        program->toggleBackend();
+    }
 }
+
+void WindowRefreshCallback(GLFWwindow* window) {
+	Program* program = (Program*)glfwGetWindowUserPointer(window);
+	program->requestPresent();
+}
+
+void FramebufferSizeCallback(GLFWwindow* window, int width, int height) {
+	Program* program = (Program*)glfwGetWindowUserPointer(window);
+	program->requestRedraw();
+}
+
+void WindowFocusCallback(GLFWwindow* window, int focused) {
+	Program* program = (Program*)glfwGetWindowUserPointer(window);
+	program->setFocused(focused == GLFW_TRUE);
+}
+
+void WindowIconifyCallback(GLFWwindow* window, int iconified) {
+	Program* program = (Program*)glfwGetWindowUserPointer(window);
+	program->setMinimized(iconified == GLFW_TRUE);
+}
@@ -7,20 +7,49 @@
 
 #ifndef PROGRAM_H_
 #define PROGRAM_H_
+
+#include <cstddef>
+#include <string>
+
+#include "FramePacer.h"
+#include "FrameStats.h"
+#include "InputScript.h"
 
 //Forward declaration of classes
 //(note this is necessary because these are pointers and it allows the #include to appear in the .cpp file)
 struct GLFWwindow;
 class RenderingEngine;
 class Scene;
+class GpuTimer;
 
+struct ProgramOptions {
+	//Key presses are saved here on exit, for replaying later
+	std::string recordPath;
+	//Replays this script in a hidden window, on a software GL context if there is one,
+	//instead of taking input, then writes a latency and frame time report
+	std::string replayPath;
+	//Where the replay report goes (the console if empty)
+	std::string reportPath;
+	//Starts on the software rasterizer instead of OpenGL
+	bool softwareRendering;
+	//Name of the kernel the Barnsley fern is generated with (the widest supported if empty)
+	std::string fernBackend;
+	//Memory the cache of recently shown levels may hold on to
+	std::size_t levelCacheMegabytes;
+
+	ProgramOptions() : softwareRendering(false), levelCacheMegabytes(512) {}
+};
+
 class Program {
 public:
-	Program();
+	explicit Program(const ProgramOptions& options = ProgramOptions());
 	virtual ~Program();
 
 	//Creates the rendering engine and the scene and does the main draw loop
 	void start();
+
+	//Adds a key press to the recording, if one is being made
+	void recordKey(int key, int scancode, int action, int mods);
 
 	//Initializes GLFW and creates the window
 	void setupWindow();
@@ -30,16 +59,73 @@ public:
 
 	Scene* getScene() { return scene; };
 
+	//The scene has to be drawn again, or only the last frame shown again (after an expose)
+	void requestRedraw() { redrawNeeded = true; }
+	void requestPresent() { presentNeeded = true; }
+
+	//Background windows are throttled and minimized ones not drawn at all
+	void setFocused(bool focused);
+	void setMinimized(bool minimized) { this->minimized = minimized; }
+
+	//Steps the frame limit through FRAME_LIMITS, and turns vsync on or off
+	void cycleFrameLimit();
+	void toggleVsync();
+
+	//Shows frame timings in the title bar, and logs them to FRAME_LOG_PATH
+	void toggleTimingOverlay();
+	void toggleTimingLog();
+
+	//Starts recording a profile, or stops and exports it to TRACE_PATH
+	void toggleProfiling();
+
+	//Switches scene drawing between OpenGL and the software rasterizer
+	void toggleBackend();
+
 private:
+	void runInteractive();
+	//Feeds the script's key presses to KeyCallback one at a time, each once the previous one has
+	//been fully shown, so the same script always does the same work
+	void replay();
+	//Updates and draws until the level asked for is on screen. Returns false if that takes
+	//longer than REPLAY_STEP_TIMEOUT.
+	bool showRequestedLevel(int& frames);
+	bool writeReplayReport(const InputScript& script, const std::vector<double>& latencies,
+		const std::vector<int>& framesPerStep, const std::vector<bool>& settled);
+
+	//Draws the scene if it changed, or shows the last frame again if only that is needed,
+	//then swaps. Returns false, doing nothing, if the window has no area to draw to.
+	bool showFrame();
+	void recordFrameTimes(double submitStart, double swapStart, double frameEnd);
+
+	ProgramOptions options;
+
 	GLFWwindow* window;
 	RenderingEngine* renderingEngine;
 	Scene* scene;
+
+	//Key presses being recorded
+	InputScript recording;
+	double recordingStart;
 
+	bool redrawNeeded;
+	bool presentNeeded;
+	bool minimized;
+	bool vsync;
+	FramePacer framePacer;
+
+	//Where frame time goes
+	FrameStats frameStats;
+	GpuTimer* gpuTimer;
+	bool showingTimings;
 };
 
 //Functions passed to GLFW to handle errors and keyboard input
 //Note, GLFW requires them to not be member functions of a class
 void ErrorCallback(int error, const char* description);
 void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void WindowRefreshCallback(GLFWwindow* window);
+void FramebufferSizeCallback(GLFWwindow* window, int width, int height);
+void WindowFocusCallback(GLFWwindow* window, int focused);
+void WindowIconifyCallback(GLFWwindow* window, int iconified);
 
 #endif /* PROGRAM_H_ */
@@ -0,0 +1,37 @@
+/*
+ * Random.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "Random.h"
+
+namespace {
+	const std::uint64_t SPLITMIX_INCREMENT = 0x9E3779B97F4A7C15ull;
+
+	//splitmix64 output function (Steele, Lea and Flood)
+	std::uint64_t mix(std::uint64_t z) {
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+}
+
+void Random::seedState(std::uint64_t seed, std::uint64_t streamIndex, std::uint32_t state[4]) {
+	std::uint64_t counter = seed + 2 * streamIndex * SPLITMIX_INCREMENT;
+	std::uint64_t first = mix(counter + SPLITMIX_INCREMENT);
+	std::uint64_t second = mix(counter + 2 * SPLITMIX_INCREMENT);
+	state[0] = static_cast<std::uint32_t>(first);
+	state[1] = static_cast<std::uint32_t>(first >> 32);
+	state[2] = static_cast<std::uint32_t>(second);
+	state[3] = static_cast<std::uint32_t>(second >> 32);
+
+	//xoshiro never leaves the all-zero state
+	if ((state[0] | state[1] | state[2] | state[3]) == 0) {
+		state[0] = 1;
+	}
+}
+
+Random::Stream::Stream(std::uint64_t seed, std::uint64_t streamIndex) {
+	seedState(seed, streamIndex, state);
+}
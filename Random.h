@@ -0,0 +1,59 @@
+/*
+ * Random.h
+ *	Seedable random streams for the random scenes. A stream is addressed by
+ *	(seed, stream index) rather than drawn from shared state, so work split across
+ *	threads or SIMD lanes gets the same numbers however it is divided.
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include <cstdint>
+
+//Random number associated functions are put in the Random namespace
+namespace Random {
+
+	//Seed the random scenes start with
+	const std::uint64_t DEFAULT_SEED = 453;
+
+	//Fills the four state words of stream `streamIndex` of `seed`. They are outputs
+	//2 * streamIndex and 2 * streamIndex + 1 of a splitmix64 sequence started at `seed`,
+	//so any stream can be started directly and neighbouring streams are unrelated.
+	void seedState(std::uint64_t seed, std::uint64_t streamIndex, std::uint32_t state[4]);
+
+	//One xoshiro128+ step (Blackman and Vigna) on state words held anywhere,
+	//e.g. one lane of a SIMD kernel. The upper bits are the strongest.
+	inline std::uint32_t nextState(std::uint32_t& s0, std::uint32_t& s1, std::uint32_t& s2, std::uint32_t& s3) {
+		std::uint32_t result = s0 + s3;
+		std::uint32_t t = s1 << 9;
+		s2 ^= s0;
+		s3 ^= s1;
+		s1 ^= s2;
+		s0 ^= s3;
+		s2 ^= t;
+		s3 = (s3 << 11) | (s3 >> 21);
+		return result;
+	}
+
+	//A single xoshiro128+ stream
+	class Stream {
+	public:
+		Stream(std::uint64_t seed, std::uint64_t streamIndex);
+
+		std::uint32_t next() { return nextState(state[0], state[1], state[2], state[3]); }
+
+		//Uniform in [0, 1), from the top 24 bits
+		float nextFloat() { return static_cast<float>(next() >> 8) * (1.0f / 16777216.0f); }
+
+		//Uniform in [0, bound), from the top bits by multiply-shift
+		std::uint32_t nextBelow(std::uint32_t bound) {
+			return static_cast<std::uint32_t>((static_cast<std::uint64_t>(next()) * bound) >> 32);
+		}
+
+	private:
+		std::uint32_t state[4];
+	};
+}
+
+#endif /* RANDOM_H_ */
@@ -6,71 +6,344 @@
  */
 
 #include "RenderingEngine.h"
+#include "Profiler.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 //cpp file purposely included here because it just contains some global functions
 #include "ShaderTools.h"
 
-RenderingEngine::RenderingEngine() {
+namespace {
+	//Floats per instance: a mat3 transform followed by a colour offset
+	const GLsizei INSTANCE_FLOATS = 9 + 3;
+
+	//Released vbos the pool may keep for reuse
+	const std::size_t POOLED_BUFFER_BUDGET = 256 * 1024 * 1024;
+
+	//Staging memory uploads are streamed through
+	const GLsizeiptr UPLOAD_RING_SIZE = 16 * 1024 * 1024;
+
+	//Gives buffer fresh storage for size bytes. Its storage is kept if the data fills at least half
+	//of it (orphaned, so draws still reading the old contents don't stall the upload); otherwise
+	//the buffer is swapped for a better sized one from the pool.
+	void reserveBuffer(GpuBufferPool& pool, GLuint& buffer, GLsizeiptr size) {
+		GLsizeiptr capacity = pool.getCapacity(buffer);
+		if (buffer && capacity >= size && capacity <= 2 * size) {
+			glBindBuffer(GL_ARRAY_BUFFER, buffer);
+			glBufferData(GL_ARRAY_BUFFER, capacity, 0, GL_STATIC_DRAW);
+		} else {
+			pool.releaseBuffer(buffer);
+			buffer = pool.acquireBuffer(size);
+		}
+	}
+
+	//Makes buffer hold size bytes of data
+	void writeBuffer(GpuBufferPool& pool, GLuint& buffer, GLsizeiptr size, const void* data) {
+		reserveBuffer(pool, buffer, size);
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		RenderingEngine::getUploadRing().write(buffer, 0, size, 1,
+			[bytes](unsigned char* out, size_t first, size_t count) {
+				std::memcpy(out, bytes + first, count);
+			});
+	}
+
+	//Swaps buffer for a pooled one with room for newSize bytes, keeping its first keptSize bytes
+	void growBuffer(GpuBufferPool& pool, GLuint& buffer, GLsizeiptr keptSize, GLsizeiptr newSize) {
+		GLuint grown = pool.acquireBuffer(newSize);
+		glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, keptSize);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		pool.releaseBuffer(buffer);
+		buffer = grown;
+	}
+
+	//Points the vertex and colour attributes of the geometry's vao at its current vbos,
+	//in the formats and at the offsets its layout gives
+	void bindVertexAttributes(const Geometry& geometry) {
+		const VertexLayout& layout = geometry.layout;
+		AttributeFormat position = layout.getPositionFormat();
+		AttributeFormat colour = layout.getColourFormat();
+
+		glBindVertexArray(geometry.vao);
+		glBindBuffer(GL_ARRAY_BUFFER, geometry.vertexBuffer);
+		glVertexAttribPointer(0, position.components, position.type, position.normalized, layout.getVertexStride(), (void*)0);
+		glEnableVertexAttribArray(0);
+
+		if (layout.interleaved) {
+			glVertexAttribPointer(1, colour.components, colour.type, colour.normalized, layout.getVertexStride(),
+				(void*)(size_t)layout.getColourOffset());
+		} else {
+			glBindBuffer(GL_ARRAY_BUFFER, geometry.colorBuffer);
+			glVertexAttribPointer(1, colour.components, colour.type, colour.normalized, layout.getColourStride(), (void*)0);
+		}
+		glEnableVertexAttribArray(1);
+		glBindVertexArray(0);
+	}
+
+	//Number of vertices the geometry's vbos have room for
+	size_t getBufferCapacity(GpuBufferPool& pool, const Geometry& geometry) {
+		const VertexLayout& layout = geometry.layout;
+		size_t capacity = pool.getCapacity(geometry.vertexBuffer) / layout.getVertexStride();
+		if (!layout.interleaved) {
+			capacity = std::min<size_t>(capacity, pool.getCapacity(geometry.colorBuffer) / layout.getColourStride());
+		}
+		return capacity;
+	}
+
+	//Packs the geometry's vertices from first on straight into its vbos, through the upload ring,
+	//gathering them from wherever they are stored
+	void uploadVertexRange(const Geometry& geometry, size_t first) {
+		const VertexLayout& layout = geometry.layout;
+		size_t count = geometry.getVertexCount() - first;
+		UploadRing& ring = RenderingEngine::getUploadRing();
+
+		GLsizei vertexStride = layout.getVertexStride();
+		ring.write(geometry.vertexBuffer, vertexStride * first, count, vertexStride,
+			[&geometry, &layout, first, vertexStride](unsigned char* out, size_t runFirst, size_t runCount) {
+				geometry.forEachVertexRun(first + runFirst, runCount,
+					[&layout, out, vertexStride](const glm::vec3* verts, const glm::vec3* colors, size_t count, size_t index) {
+						packVertexData(layout, verts, colors, count, out + index * vertexStride);
+					});
+			});
+
+		if (!layout.interleaved) {
+			GLsizei colourStride = layout.getColourStride();
+			ring.write(geometry.colorBuffer, colourStride * first, count, colourStride,
+				[&geometry, &layout, first, colourStride](unsigned char* out, size_t runFirst, size_t runCount) {
+					geometry.forEachVertexRun(first + runFirst, runCount,
+						[&layout, out, colourStride](const glm::vec3*, const glm::vec3* colors, size_t count, size_t index) {
+							packColourData(layout, colors, count, out + index * colourStride);
+						});
+				});
+		}
+	}
+}
+
+RenderingEngine::RenderingEngine() : frameBuffer(0), frameColour(0), frameWidth(0), frameHeight(0), frameValid(false),
+		backend(OPENGL_BACKEND), softwareTexture(0), softwareFramebuffer(0) {
 	shaderProgram = ShaderTools::InitializeShaders();
 	if (shaderProgram == 0) {
 		std::cout << "Program could not initialize shaders, TERMINATING" << std::endl;
 		return;
 	}
+
+	instancedProgram = ShaderTools::InitializeShaders("shaders/instanced_vertex.glsl", "shaders/instanced_fragment.glsl");
+	if (instancedProgram == 0) {
+		std::cout << "Program could not initialize instanced shaders" << std::endl;
+	}
+
+	densityProgram = ShaderTools::InitializeShaders("shaders/density_vertex.glsl", "shaders/density_fragment.glsl");
+	if (densityProgram == 0) {
+		std::cout << "Program could not initialize density shaders" << std::endl;
+	}
+
+	//Core profile needs a vao bound to draw, even though the density pass reads no attributes
+	glGenVertexArrays(1, &densityVao);
 }
 
 RenderingEngine::~RenderingEngine() {
-
+	if (frameBuffer) {
+		glDeleteFramebuffers(1, &frameBuffer);
+		glDeleteRenderbuffers(1, &frameColour);
+	}
+	if (softwareFramebuffer) {
+		glDeleteFramebuffers(1, &softwareFramebuffer);
+		glDeleteTextures(1, &softwareTexture);
+	}
 }
 
 void RenderingEngine::RenderScene(const std::vector<Geometry>& objects) {
+	PROFILE_ZONE("RenderScene");
+	if (backend == SOFTWARE_BACKEND) {
+		renderSoftware(objects);
+		return;
+	}
+
 	//Clears the screen to a dark grey background
 	glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 
 	// bind our shader program and the vertex array object containing our
-	// scene geometry, then tell OpenGL to draw our geometry
-	glUseProgram(shaderProgram);
+	// scene geometry, then tell OpenGL to draw our geometry.
+	// Objects sharing a draw mode and layout arrive batched into one geometry,
+	// so this is one draw call per batch rather than per object.
+	GLuint currentProgram = 0;
+	for (const Geometry& g : objects) {
+		GLuint program = (g.instanceCount > 0) ? instancedProgram : shaderProgram;
+		if (program != currentProgram) {
+			glUseProgram(program);
+			currentProgram = program;
+		}
 
-	for (const Geometry& g : objects) {
 		glBindVertexArray(g.vao);
-		glDrawArrays(g.drawMode, 0, g.verts.size());
+		if (g.instanceCount > 0) {
+			glDrawArraysInstanced(g.drawMode, 0, g.getVertexCount(), g.instanceCount);
+		} else if (g.vertexCounts.size() > 1) {
+			glMultiDrawArrays(g.drawMode, g.firstVertices.data(), g.vertexCounts.data(), g.vertexCounts.size());
+		} else {
+			glDrawArrays(g.drawMode, 0, g.getVertexCount());
+		}
+	}
 
-		// reset state to default (no shader or geometry bound)
-		glBindVertexArray(0);
-	}
+	// reset state to default (no shader or geometry bound)
+	glBindVertexArray(0);
 	glUseProgram(0);
 
 	// check for an report any OpenGL errors
 	CheckGLErrors();
 }
 
+//Rasterizes the objects on the CPU at the size of the viewport, then blits the image into it
+void RenderingEngine::renderSoftware(const std::vector<Geometry>& objects) {
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	{
+		PROFILE_ZONE("SoftwareRasterize");
+		softwareRasterizer.resize(viewport[2], viewport[3]);
+		softwareRasterizer.clear(glm::vec3(0.2f, 0.2f, 0.2f));
+		softwareRasterizer.draw(objects);
+	}
+	blitSoftwareImage(viewport);
+}
+
+//Tone-maps the histogram on the CPU at the size of the viewport, then blits the image into it
+void RenderingEngine::renderSoftwareDensity(const DensityHistogram& histogram) {
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	{
+		PROFILE_ZONE("SoftwareDensity");
+		softwareRasterizer.resize(viewport[2], viewport[3]);
+		softwareRasterizer.drawDensity(histogram, glm::vec3(0.2f, 0.2f, 0.2f));
+	}
+	blitSoftwareImage(viewport);
+}
+
+//Uploads the software rasterizer's image and blits it into the viewport of the bound framebuffer
+void RenderingEngine::blitSoftwareImage(const GLint viewport[4]) {
+	int width = viewport[2], height = viewport[3];
+	if (width <= 0 || height <= 0) {
+		return;
+	}
+
+	if (!softwareFramebuffer) {
+		glGenTextures(1, &softwareTexture);
+		glGenFramebuffers(1, &softwareFramebuffer);
+	}
+	//Rows are stored bottom first, as OpenGL expects
+	glBindTexture(GL_TEXTURE_2D, softwareTexture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+		softwareRasterizer.getPixels().data());
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	GLint drawFramebuffer = 0;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFramebuffer);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, softwareFramebuffer);
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, softwareTexture, 0);
+	glBlitFramebuffer(0, 0, width, height, viewport[0], viewport[1], viewport[0] + width, viewport[1] + height,
+		GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, drawFramebuffer);
+
+	CheckGLErrors();
+}
+
+void RenderingEngine::RenderDensity(GLuint densityTexture, const DensityHistogram& histogram) {
+	PROFILE_ZONE("RenderDensity");
+	if (backend == SOFTWARE_BACKEND) {
+		renderSoftwareDensity(histogram);
+		return;
+	}
+
+	const glm::vec3& colour = histogram.colour;
+	glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	glUseProgram(densityProgram);
+	glUniform1i(glGetUniformLocation(densityProgram, "Density"), 0);
+	glUniform3f(glGetUniformLocation(densityProgram, "DensityColour"), colour[0], colour[1], colour[2]);
+	glUniform3f(glGetUniformLocation(densityProgram, "BackgroundColour"), 0.2f, 0.2f, 0.2f);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, densityTexture);
+	glBindVertexArray(densityVao);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glUseProgram(0);
+
+	CheckGLErrors();
+}
+
+void RenderingEngine::beginFrame(int width, int height) {
+	if (!frameBuffer) {
+		glGenFramebuffers(1, &frameBuffer);
+		glGenRenderbuffers(1, &frameColour);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+	if (width != frameWidth || height != frameHeight) {
+		glBindRenderbuffer(GL_RENDERBUFFER, frameColour);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, frameColour);
+		frameWidth = width;
+		frameHeight = height;
+	}
+	glViewport(0, 0, width, height);
+	frameValid = false;
+}
+
+void RenderingEngine::endFrame() {
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	frameValid = true;
+}
+
+bool RenderingEngine::presentFrame(int width, int height) {
+	if (!frameValid || width != frameWidth || height != frameHeight) {
+		return false;
+	}
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, frameBuffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	return true;
+}
+
+GpuBufferPool& RenderingEngine::getBufferPool() {
+	static GpuBufferPool pool(POOLED_BUFFER_BUDGET);
+	return pool;
+}
+
+UploadRing& RenderingEngine::getUploadRing() {
+	static UploadRing ring(UPLOAD_RING_SIZE);
+	return ring;
+}
+
 void RenderingEngine::assignBuffers(Geometry& geometry) {
-	//Generate vao for the object
-	//Constant 1 means 1 vao is being generated
-	glGenVertexArrays(1, &geometry.vao);
+	//Take a vao for the object from the pool. It may have been used before, so switch off
+	//the instance attributes (2 to 5) an earlier owner may have left on.
+	geometry.vao = getBufferPool().acquireVertexArray();
 	glBindVertexArray(geometry.vao);
+	for (GLuint i = 2; i < 6; i++) {
+		glDisableVertexAttribArray(i);
+	}
 
-	//Generate vbos for the object
-	//Constant 1 means 1 vbo is being generated
-	glGenBuffers(1, &geometry.vertexBuffer);
-	glBindBuffer(GL_ARRAY_BUFFER, geometry.vertexBuffer);
-	//Parameters in order: Index of vbo in the vao, number of primitives per element, primitive type, etc.
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-	glEnableVertexAttribArray(0);
+	//The vbos are taken from the pool by setBufferData, once their size is known.
+	//It then points attributes 0 (position) and 1 (colour) at them.
 
 	/*glGenBuffers(1, &geometry.normalBuffer);
 	glBindBuffer(GL_ARRAY_BUFFER, geometry.normalBuffer);
 	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
 	glEnableVertexAttribArray(2);*/
 
-	glGenBuffers(1, &geometry.colorBuffer);
-	glBindBuffer(GL_ARRAY_BUFFER, geometry.colorBuffer);
-	//Parameters in order: Index of vbo in the vao, number of primitives per element, primitive type, etc.
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-	glEnableVertexAttribArray(1);
-
+	glBindVertexArray(0);
 	/*glGenBuffers(1, &geometry.uvBuffer);
 	glBindBuffer(GL_ARRAY_BUFFER, geometry.uvBuffer);
 	glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
@@ -80,29 +353,188 @@ void RenderingEngine::assignBuffers(Geometry& geometry) {
 }
 
 void RenderingEngine::setBufferData(Geometry& geometry) {
+	PROFILE_ZONE("setBufferData");
 	//Send geometry to the GPU
 	//Must be called whenever anything is updated about the object
-	glBindBuffer(GL_ARRAY_BUFFER, geometry.vertexBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * geometry.verts.size(), geometry.verts.data(), GL_STATIC_DRAW);
+	GpuBufferPool& pool = getBufferPool();
+	const VertexLayout& layout = geometry.layout;
+	size_t vertexCount = geometry.getVertexCount();
+	reserveBuffer(pool, geometry.vertexBuffer, layout.getVertexStride() * vertexCount);
 
-	/*glBindBuffer(GL_ARRAY_BUFFER, geometry.normalBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * geometry.normals.size(), geometry.normals.data(), GL_STATIC_DRAW);*/
+	/*glBindBuffer(GL_ARRAY_BUFFER, geometry.normalBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * geometry.normals.size(), geometry.normals.data(), GL_STATIC_DRAW);*/
 
-	glBindBuffer(GL_ARRAY_BUFFER, geometry.colorBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * geometry.colors.size(), geometry.colors.data(), GL_STATIC_DRAW);
+	if (layout.interleaved) {
+		pool.releaseBuffer(geometry.colorBuffer);
+		geometry.colorBuffer = 0;
+	} else {
+		reserveBuffer(pool, geometry.colorBuffer, layout.getColourStride() * vertexCount);
+	}
+
+	//Packed straight into GPU-visible memory, with no staging vector or glBufferData copy
+	uploadVertexRange(geometry, 0);
+
+	//Either vbo may have been swapped for a pooled one
+	bindVertexAttributes(geometry);
+	geometry.bufferCapacity = getBufferCapacity(pool, geometry);
 
 	/*glBindBuffer(GL_ARRAY_BUFFER, geometry.uvBuffer);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * geometry.uvs.size(), geometry.uvs.data(), GL_STATIC_DRAW);*/
 }
 
+void RenderingEngine::appendBufferData(Geometry& geometry, size_t firstNewVertex) {
+	PROFILE_ZONE("appendBufferData");
+	size_t vertexCount = geometry.getVertexCount();
+	if (vertexCount > geometry.bufferCapacity) {
+		//Grow geometrically so a run of appends costs amortised O(new vertices)
+		GpuBufferPool& pool = getBufferPool();
+		size_t newCapacity = std::max(vertexCount, 2 * geometry.bufferCapacity);
+		GLsizei vertexStride = geometry.layout.getVertexStride();
+		growBuffer(pool, geometry.vertexBuffer, vertexStride * firstNewVertex, vertexStride * newCapacity);
+		if (!geometry.layout.interleaved) {
+			GLsizei colourStride = geometry.layout.getColourStride();
+			growBuffer(pool, geometry.colorBuffer, colourStride * firstNewVertex, colourStride * newCapacity);
+		}
+		bindVertexAttributes(geometry);
+		geometry.bufferCapacity = getBufferCapacity(pool, geometry);
+	}
+
+	//Nothing queued draws beyond the old vertex count, so the new range can be written in place
+	uploadVertexRange(geometry, firstNewVertex);
+}
+
 void RenderingEngine::deleteBufferData(Geometry& geometry) {
-	glDeleteBuffers(1, &geometry.vertexBuffer);
+	GpuBufferPool& pool = getBufferPool();
+	pool.releaseBuffer(geometry.vertexBuffer);
 	glDeleteBuffers(1, &geometry.normalBuffer);
-	glDeleteBuffers(1, &geometry.colorBuffer);
+	pool.releaseBuffer(geometry.colorBuffer);
 	glDeleteBuffers(1, &geometry.uvBuffer);
-	glDeleteVertexArrays(1, &geometry.vao);
+	pool.releaseBuffer(geometry.instanceBuffer);
+	pool.releaseVertexArray(geometry.vao);
+
+	geometry.vao = 0;
+	geometry.vertexBuffer = 0;
+	geometry.normalBuffer = 0;
+	geometry.colorBuffer = 0;
+	geometry.uvBuffer = 0;
+	geometry.instanceBuffer = 0;
+	geometry.bufferCapacity = 0;
+	geometry.instanceCount = 0;
+	geometry.instanceTransforms.clear();
+	geometry.instanceColourOffsets.clear();
+}
+
+void RenderingEngine::assignInstanceBuffer(Geometry& geometry) {
+	//A mat3 attribute takes one location per column (2 to 4), then the colour offset (5).
+	//Divisor 1 advances them once per instance instead of once per vertex.
+	//The vbo itself is taken from the pool by setInstanceData.
+	glBindVertexArray(geometry.vao);
+	for (GLuint i = 0; i < 4; i++) {
+		glEnableVertexAttribArray(2 + i);
+		glVertexAttribDivisor(2 + i, 1);
+	}
+	glBindVertexArray(0);
+}
+
+void RenderingEngine::setInstanceData(Geometry& geometry, const std::vector<glm::mat3>& transforms,
+		const std::vector<glm::vec3>& colourOffsets) {
+	//Interleaved so each instance is one contiguous 48 byte record
+	std::vector<float> instances(transforms.size() * INSTANCE_FLOATS);
+	for (size_t i = 0; i < transforms.size(); i++) {
+		float* instance = &instances[i * INSTANCE_FLOATS];
+		for (int column = 0; column < 3; column++) {
+			for (int row = 0; row < 3; row++) {
+				instance[3 * column + row] = transforms[i][column][row];
+			}
+		}
+		instance[9] = colourOffsets[i][0];
+		instance[10] = colourOffsets[i][1];
+		instance[11] = colourOffsets[i][2];
+	}
+
+	writeBuffer(getBufferPool(), geometry.instanceBuffer, sizeof(float) * instances.size(), instances.data());
+	geometry.instanceCount = transforms.size();
+	geometry.instanceTransforms = transforms;
+	geometry.instanceColourOffsets = colourOffsets;
+
+	//The attribute pointers read from whatever buffer is bound, which writeBuffer may have changed
+	glBindVertexArray(geometry.vao);
+	glBindBuffer(GL_ARRAY_BUFFER, geometry.instanceBuffer);
+	GLsizei stride = INSTANCE_FLOATS * sizeof(float);
+	for (GLuint i = 0; i < 4; i++) {
+		glVertexAttribPointer(2 + i, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * i * sizeof(float)));
+	}
+	glBindVertexArray(0);
 }
 
+void RenderingEngine::assignDensityTexture(GLuint& texture) {
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	//One cell per texel, so no filtering or mipmaps
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void RenderingEngine::setDensityTextureData(GLuint texture, const DensityHistogram& histogram) {
+	//Upload cost depends only on the grid size, not on how many points were binned
+	std::vector<unsigned char> intensities;
+	histogram.toneMap(intensities);
+
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, histogram.getWidth(), histogram.getHeight(), 0,
+		GL_RED, GL_UNSIGNED_BYTE, intensities.data());
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void RenderingEngine::deleteDensityTexture(GLuint& texture) {
+	glDeleteTextures(1, &texture);
+	texture = 0;
+}
+
+size_t RenderingEngine::getGpuByteSize(const Geometry& geometry) {
+	GpuBufferPool& pool = getBufferPool();
+	return pool.getCapacity(geometry.vertexBuffer) + pool.getCapacity(geometry.colorBuffer) +
+		pool.getCapacity(geometry.normalBuffer) + pool.getCapacity(geometry.uvBuffer) +
+		pool.getCapacity(geometry.instanceBuffer);
+}
+
+size_t RenderingEngine::getDensityTextureByteSize(const DensityHistogram& histogram) {
+	//One GL_R8 texel per bin
+	return (size_t)histogram.getWidth() * histogram.getHeight();
+}
+
+GLuint RenderingEngine::getDrawMode(PrimitiveType primitive) {
+	switch (primitive) {
+	case LINE_STRIP_PRIMITIVE:
+		return GL_LINE_STRIP;
+	case TRIANGLES_PRIMITIVE:
+		return GL_TRIANGLES;
+	case LINES_PRIMITIVE:
+		return GL_LINES;
+	case POINTS_PRIMITIVE:
+	default:
+		return GL_POINTS;
+	}
+}
+
+PrimitiveType RenderingEngine::getPrimitiveType(GLuint drawMode) {
+	switch (drawMode) {
+	case GL_LINE_STRIP:
+		return LINE_STRIP_PRIMITIVE;
+	case GL_TRIANGLES:
+		return TRIANGLES_PRIMITIVE;
+	case GL_LINES:
+		return LINES_PRIMITIVE;
+	case GL_POINTS:
+	default:
+		return POINTS_PRIMITIVE;
+	}
+}
+
 bool RenderingEngine::CheckGLErrors() {
 	bool error = false;
 	for (GLenum flag = glGetError(); flag != GL_NO_ERROR; flag = glGetError())
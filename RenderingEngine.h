@@ -13,6 +13,11 @@
 #include <GLFW/glfw3.h>
 
 #include "Geometry.h"
+#include "GpuBufferPool.h"
+#include "UploadRing.h"
+#include "GeometryBuilder.h"
+#include "DensityHistogram.h"
+#include "SoftwareRasterizer.h"
 
 //Forward declaration of classes
 //(note this is necessary because these are pointers and it allows the #include to appear in the .cpp file)
@@ -22,14 +27,58 @@ class RenderingEngine {
 public:
 	RenderingEngine();
 	virtual ~RenderingEngine();
+
+	//What RenderScene and RenderDensity draw with: OpenGL, or the CPU rasterizer whose image
+	//is then copied to the framebuffer bound when they are called
+	enum Backend { OPENGL_BACKEND, SOFTWARE_BACKEND };
+	void setBackend(Backend backend) { this->backend = backend; }
+	Backend getBackend() const { return backend; }
 
 	//Renders each object
 	void RenderScene(const std::vector<Geometry>& objects);
 
+	//Draws a tone-mapped density texture across the whole window in the histogram's colour.
+	//The software backend tone-maps the histogram itself rather than reading the texture.
+	void RenderDensity(GLuint densityTexture, const DensityHistogram& histogram);
+
+	//Frames are drawn into an offscreen copy between beginFrame and endFrame, so the last one
+	//can be shown again (when the window is exposed) without drawing the scene
+	void beginFrame(int width, int height);
+	void endFrame();
+	//Copies the last frame to the window; false if there is none of this size to copy
+	bool presentFrame(int width, int height);
+
 	//Create vao and vbos for objects
 	static void assignBuffers(Geometry& geometry);
 	static void setBufferData(Geometry& geometry);
+	//Uploads only the vertices from firstNewVertex on, growing the vbos when they are full
+	static void appendBufferData(Geometry& geometry, size_t firstNewVertex);
+	//Hands the vao and vbos back to the buffer pool. Must be called before a geometry is dropped.
 	static void deleteBufferData(Geometry& geometry);
+
+	//Where the vaos and vbos of all geometry come from
+	static GpuBufferPool& getBufferPool();
+	//What vertex and instance data is uploaded through
+	static UploadRing& getUploadRing();
+
+	//Create and fill the per-instance vbo of a geometry drawn as many transformed copies.
+	//Call after assignBuffers, as the instance attributes are added to the geometry's vao.
+	static void assignInstanceBuffer(Geometry& geometry);
+	static void setInstanceData(Geometry& geometry, const std::vector<glm::mat3>& transforms,
+		const std::vector<glm::vec3>& colourOffsets);
+
+	//Create, fill and delete the single-channel texture a density histogram is drawn from
+	static void assignDensityTexture(GLuint& texture);
+	static void setDensityTextureData(GLuint texture, const DensityHistogram& histogram);
+	static void deleteDensityTexture(GLuint& texture);
+
+	//Bytes of GPU storage behind a geometry's vbos, and behind a density texture
+	static size_t getGpuByteSize(const Geometry& geometry);
+	static size_t getDensityTextureByteSize(const DensityHistogram& histogram);
+
+	//Maps a generator primitive type to the OpenGL draw mode
+	static GLuint getDrawMode(PrimitiveType primitive);
+	static PrimitiveType getPrimitiveType(GLuint drawMode);
 
 	//Ensures that vao and vbos are set up properly
 	bool CheckGLErrors();
@@ -37,6 +86,30 @@ public:
 private:
 	//Pointer to the current shader program being used to render
 	GLuint shaderProgram;
+
+	//Shader used for geometry with an instance buffer
+	GLuint instancedProgram;
+
+	//Shader and (empty) vao used to draw density textures
+	GLuint densityProgram;
+	GLuint densityVao;
+
+	//Offscreen copy of the last frame drawn
+	GLuint frameBuffer;
+	GLuint frameColour;
+	int frameWidth;
+	int frameHeight;
+	bool frameValid;
+
+	//Software backend, and the texture and framebuffer its image is blitted from
+	Backend backend;
+	SoftwareRasterizer softwareRasterizer;
+	GLuint softwareTexture;
+	GLuint softwareFramebuffer;
+
+	void renderSoftware(const std::vector<Geometry>& objects);
+	void renderSoftwareDensity(const DensityHistogram& histogram);
+	void blitSoftwareImage(const GLint viewport[4]);
 };
 
 #endif /* RENDERINGENGINE_H_ */
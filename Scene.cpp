@@ -8,500 +8,908 @@
 #include "Scene.h"
 
 #include "RenderingEngine.h"
+#include "GeometryBuilder.h"
+#include "Profiler.h"
+#include "ThreadTools.h"
 
 //**Must include glad and GLFW in this order or it breaks**
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
-
+#include <sstream>
+
 namespace
 {
-    const glm::vec3 TEAL_COLOUR(0.25f, 0.75f, 0.75f);
-    const glm::vec3 GOLD_COLOUR(0.7f, 0.7f, 0.5f);
-    const glm::vec3 BLUE_COLOUR(0.25f, 0.0f, 0.75f);
-    const glm::vec3 RED_COLOUR(0.5f, 0.25f, 0.1f);
-}
-
-Scene::Scene(RenderingEngine* renderer)
-: numberOfIterations(1), renderer(renderer)
+    //Cells per side of the density grid, one per pixel of the default window
+    const int DENSITY_GRID_SIZE = 512;
+
+    //Most a level grows by from the one below it (the Hilbert curve's four copies), used to
+    //judge whether prefetching the next level could fit in the cache
+    const std::size_t NEXT_LEVEL_GROWTH = 4;
+
+    const char* const SCENE_TYPES[] = { "NESTED_SQUARE_SCENE", "SPIRAL_SCENE", "SIERPINSKI_TRIANGLE_SCENE",
+        "RANDOM_SIERPINSKI_SCENE", "BARNSLEY_FERN_SCENE", "HILBERT_CURVE_SCENE" };
+
+    std::shared_ptr<DensityHistogram> makeDensityHistogram()
+    {
+        return std::make_shared<DensityHistogram>(DENSITY_GRID_SIZE, DENSITY_GRID_SIZE, -1.0f, -1.0f, 1.0f, 1.0f);
+    }
+
+    //Level numberOfIterations of an appending scene, as the parts of `previous`, shared rather
+    //than copied, plus what the generator adds. Null if the generator is not at the level below.
+    std::shared_ptr<GeneratedLevel> appendNextLevel(GeometryBuilder::AppendingGenerator& generator,
+        int numberOfIterations, const GeneratedLevel& previous)
+    {
+        if (generator.getLevel() != numberOfIterations - 1 || previous.density ||
+            !previous.instanced.transforms.empty() || previous.parts.empty())
+        {
+            return std::shared_ptr<GeneratedLevel>();
+        }
+
+        GeometryAppend append;
+        generator.buildNextLevel(append);
+
+        std::shared_ptr<GeneratedLevel> level = std::make_shared<GeneratedLevel>();
+        level->parts = previous.parts;
+        if (!append.tail.verts.empty())
+        {
+            std::vector<GeometryData> tail(1);
+            tail[0].verts.swap(append.tail.verts);
+            tail[0].colors.swap(append.tail.colors);
+            tail[0].primitive = previous.parts.back().data->primitive;
+            level->addObjects(tail);
+            level->parts.back().continuesObject = true;
+        }
+        level->addObjects(append.newObjects);
+        return level;
+    }
+
+    //Density variant of the above, for the chaos-game generators
+    template <class Generator>
+    std::shared_ptr<GeneratedLevel> appendNextDensityLevel(Generator& generator, int numberOfIterations,
+        const GeneratedLevel& previous)
+    {
+        if (generator.getLevel() != numberOfIterations - 1 || !previous.density)
+        {
+            return std::shared_ptr<GeneratedLevel>();
+        }
+
+        std::shared_ptr<GeneratedLevel> level = std::make_shared<GeneratedLevel>();
+        level->density = std::make_shared<DensityHistogram>(*previous.density);
+        generator.buildNextDensityLevel(*level->density);
+        return level;
+    }
+
+    //Level numberOfIterations of a self-similar scene, made of copies of `previous`.
+    //Null unless `previous` is a single plain level to build from.
+    std::shared_ptr<GeneratedLevel> replicateNextLevel(void (*buildNextLevel)(int, std::vector<GeometryData>&),
+        int numberOfIterations, const GeneratedLevel& previous)
+    {
+        if (previous.parts.size() != 1 || previous.density || !previous.instanced.transforms.empty())
+        {
+            return std::shared_ptr<GeneratedLevel>();
+        }
+
+        std::vector<GeometryData> objects(1, *previous.parts[0].data);
+        buildNextLevel(numberOfIterations, objects);
+        std::shared_ptr<GeneratedLevel> level = std::make_shared<GeneratedLevel>();
+        level->addObjects(objects);
+        return level;
+    }
+
+    //GPU vertex layout of each scene's objects. The chaos-game and self-similar scenes are
+    //millions of vertices, so they are packed into 8 bytes a vertex: 16-bit fixed point where
+    //they stay inside [-1, 1], half floats for the fern, which reaches past it.
+    const VertexLayout& getVertexLayout(const std::string& sceneType)
+    {
+        if (sceneType == "BARNSLEY_FERN_SCENE")
+        {
+            return VertexLayouts::HALF;
+        }
+        if (sceneType == "RANDOM_SIERPINSKI_SCENE" || sceneType == "SIERPINSKI_TRIANGLE_SCENE" ||
+            sceneType == "HILBERT_CURVE_SCENE")
+        {
+            return VertexLayouts::QUANTIZED;
+        }
+        return VertexLayouts::COMPACT;
+    }
+
+    const char* getDrawModeName(GLuint drawMode)
+    {
+        switch (drawMode)
+        {
+        case GL_POINTS:
+            return "points";
+        case GL_LINES:
+            return "lines";
+        case GL_LINE_STRIP:
+            return "line strips";
+        case GL_TRIANGLES:
+            return "triangles";
+        default:
+            return "primitives";
+        }
+    }
+
+    std::string getLevelName(const LevelKey& key)
+    {
+        std::ostringstream name;
+        name << key.scene << " level " << key.level;
+        if (!key.parameters.empty())
+        {
+            name << " (" << key.parameters << ")";
+        }
+        return name.str();
+    }
+
+    //Draws the part's vertices from the part itself, which the geometry keeps alive
+    void shareVertices(Geometry& geometry, const std::shared_ptr<const GeometryData>& data)
+    {
+        const glm::vec3* colors = data->colors.size() >= data->verts.size() ? data->colors.data() : 0;
+        geometry.addSharedVertices(data, data->verts.data(), colors, data->verts.size());
+    }
+
+    //Scenes where every level starts with the level below it
+    bool isAppendingScene(const std::string& sceneType)
+    {
+        return sceneType == "NESTED_SQUARE_SCENE" || sceneType == "RANDOM_SIERPINSKI_SCENE" ||
+            sceneType == "BARNSLEY_FERN_SCENE";
+    }
+}
+
+Scene::Scene(RenderingEngine* renderer, std::size_t levelCacheBudget)
+: numberOfIterations(1), renderer(renderer), displayedPartCount(0), lastObjectBatch(0), randomSeed(Random::DEFAULT_SEED),
+  randomSierpinskiGenerator(randomSeed), fernGenerator(randomSeed), densityMode(false), showingDensity(false),
+  densityHistogram(DENSITY_GRID_SIZE, DENSITY_GRID_SIZE, -1.0f, -1.0f, 1.0f, 1.0f), densityTexture(0),
+  instancedMode(false), levelCache(levelCacheBudget), showingLevel(false), redrawNeeded(true),
+  generationSeconds(0.0), uploadSeconds(0.0), prefetching(true)
 {
 	changeToNestedSquareScene();
 }
 
 Scene::~Scene()
 {
+    clearObjects();
+    if (densityTexture)
+    {
+        RenderingEngine::deleteDensityTexture(densityTexture);
+    }
 }
 
-//Note this method was adapted from http://www.latenightpc.com/blog/archives/2007/11/13/the-hilbert-curve-in-javal-lua-and-c
 void Scene::changeToHilbertCurveScene()
 {
     sceneType = "HILBERT_CURVE_SCENE";
     numberOfIterations = 1;
-    
-    drawHilbertCurve();
+
+    requestLevel();
 }
 
-void Scene::drawHilbertCurve()
+std::shared_ptr<GeneratedLevel> Scene::generateHilbertCurve(const LevelSettings& settings)
 {
-    objects.clear();
-    Geometry hilbertCurve;
-    hilbertCurve.drawMode = GL_LINE_STRIP;
-    float segmentLength = 1.0f / (2.0f * static_cast<float>(numberOfIterations));
-    glm::vec3 startingPoint(-1.0f, -1.0f, 1.0);
-    hilbertA(startingPoint, numberOfIterations, segmentLength, hilbertCurve);
-    
-    RenderingEngine::assignBuffers(hilbertCurve);
-    RenderingEngine::setBufferData(hilbertCurve);
-    objects.push_back(hilbertCurve);
-}
-
-void Scene::hilbertA(glm::vec3& currentPosition, int currentLevel, float segmentLength, Geometry& hilbertCurve)
-{
-    if (currentLevel > 0)
-    {
-        hilbertB(currentPosition, currentLevel-1, segmentLength, hilbertCurve);
-        
-        currentPosition = glm::vec3(currentPosition[0], currentPosition[1] + segmentLength, 1.0);
-        hilbertCurve.verts.push_back(currentPosition);
-        hilbertCurve.colors.push_back(RED_COLOUR);
-        
-        hilbertA(currentPosition, currentLevel-1, segmentLength, hilbertCurve);
-        
-        currentPosition = glm::vec3(currentPosition[0] + segmentLength, currentPosition[1], 1.0);
-        hilbertCurve.verts.push_back(currentPosition);
-        hilbertCurve.colors.push_back(RED_COLOUR);
-        
-        hilbertA(currentPosition, currentLevel-1, segmentLength, hilbertCurve);
-        
-        currentPosition = glm::vec3(currentPosition[0], currentPosition[1] - segmentLength, 1.0);
-        hilbertCurve.verts.push_back(currentPosition);
-        hilbertCurve.colors.push_back(RED_COLOUR);
-        
-        hilbertC(currentPosition, currentLevel-1, segmentLength, hilbertCurve);
-    }
-}
-
-void Scene::hilbertB(glm::vec3& currentPosition, int currentLevel, float segmentLength, Geometry& hilbertCurve)
-{
-    if (currentLevel > 0)
-    {
-        hilbertA(currentPosition, currentLevel-1, segmentLength, hilbertCurve);
-        
-        currentPosition = glm::vec3(currentPosition[0] + segmentLength, currentPosition[1], 1.0);
-        hilbertCurve.verts.push_back(currentPosition);
-        hilbertCurve.colors.push_back(RED_COLOUR);
-        
-        hilbertB(currentPosition, currentLevel-1, segmentLength, hilbertCurve);
-        
-        currentPosition = glm::vec3(currentPosition[0], currentPosition[1] + segmentLength, 1.0);
-        hilbertCurve.verts.push_back(currentPosition);
-        hilbertCurve.colors.push_back(RED_COLOUR);
-        
-        hilbertB(currentPosition, currentLevel-1, segmentLength, hilbertCurve);
-        
-        currentPosition = glm::vec3(currentPosition[0] - segmentLength, currentPosition[1], 1.0);
-        hilbertCurve.verts.push_back(currentPosition);
-        hilbertCurve.colors.push_back(RED_COLOUR);
-        
-        hilbertD(currentPosition, currentLevel-1, segmentLength, hilbertCurve);
-    }
-}
-
-void Scene::hilbertC(glm::vec3& currentPosition, int currentLevel, float segmentLength, Geometry& hilbertCurve)
-{
-    if (currentLevel > 0)
-    {
-        hilbertD(currentPosition, currentLevel-1, segmentLength, hilbertCurve);
-        
-        currentPosition = glm::vec3(currentPosition[0] - segmentLength, currentPosition[1], 1.0);
-        hilbertCurve.verts.push_back(currentPosition);
-        hilbertCurve.colors.push_back(RED_COLOUR);
-        
-        hilbertC(currentPosition, currentLevel-1, segmentLength, hilbertCurve);
-        
-        currentPosition = glm::vec3(currentPosition[0], currentPosition[1] - segmentLength, 1.0);
-        hilbertCurve.verts.push_back(currentPosition);
-        hilbertCurve.colors.push_back(RED_COLOUR);
-        
-        hilbertC(currentPosition, currentLevel-1, segmentLength, hilbertCurve);
-        
-        currentPosition = glm::vec3(currentPosition[0] + segmentLength, currentPosition[1], 1.0);
-        hilbertCurve.verts.push_back(currentPosition);
-        hilbertCurve.colors.push_back(RED_COLOUR);
-        
-        hilbertA(currentPosition, currentLevel-1, segmentLength, hilbertCurve);
-    }
-}
-
-void Scene::hilbertD(glm::vec3& currentPosition, int currentLevel, float segmentLength, Geometry& hilbertCurve)
-{
-    if (currentLevel > 0)
-    {
-        hilbertC(currentPosition, currentLevel-1, segmentLength, hilbertCurve);
-        
-        currentPosition = glm::vec3(currentPosition[0], currentPosition[1] - segmentLength, 1.0);
-        hilbertCurve.verts.push_back(currentPosition);
-        hilbertCurve.colors.push_back(RED_COLOUR);
-        
-        hilbertD(currentPosition, currentLevel-1, segmentLength, hilbertCurve);
-        
-        currentPosition = glm::vec3(currentPosition[0] - segmentLength, currentPosition[1], 1.0);
-        hilbertCurve.verts.push_back(currentPosition);
-        hilbertCurve.colors.push_back(RED_COLOUR);
-        
-        hilbertD(currentPosition, currentLevel-1, segmentLength, hilbertCurve);
-        
-        currentPosition = glm::vec3(currentPosition[0], currentPosition[1] + segmentLength, 1.0);
-        hilbertCurve.verts.push_back(currentPosition);
-        hilbertCurve.colors.push_back(RED_COLOUR);
-    
-        hilbertB(currentPosition, currentLevel-1, segmentLength, hilbertCurve);
+    PROFILE_ZONE("generate Hilbert curve");
+    std::shared_ptr<GeneratedLevel> generated = std::make_shared<GeneratedLevel>();
+    std::vector<GeometryData> objects;
+    if (settings.instancedMode)
+    {
+        GeometryBuilder::buildHilbertCurveInstanced(settings.numberOfIterations, generated->instanced, objects);
+    }
+    else
+    {
+        GeometryBuilder::buildHilbertCurve(settings.numberOfIterations, objects);
     }
+    generated->addObjects(objects);
+    return generated;
 }
 
 void Scene::changeToBarnsleyFernScene()
 {
     sceneType = "BARNSLEY_FERN_SCENE";
     numberOfIterations = 1;
-    drawBarnsleyFern();
+    requestLevel();
 }
 
-//Note that this method was adapted from https://people.sc.fsu.edu/~jburkardt/cpp_src/fern_opengl/fern.cpp
-void Scene::drawBarnsleyFern()
+std::shared_ptr<GeneratedLevel> Scene::generateBarnsleyFern(const LevelSettings& settings)
 {
-    objects.clear();
-    Geometry barnsleyFern;
-    barnsleyFern.drawMode = GL_POINTS;
-    
-    double probabilityThresholds[4] = {0.85, 0.92, 0.99};
-    int pointsPerIteration = 1e6;
-    
-    float currentX = static_cast<float>(drand48());
-    float currentY = static_cast<float>(drand48());
-    
-    for (int i = 0; i < pointsPerIteration * numberOfIterations; i++)
-    {
-        double randomPercentage = drand48();
-      
-        if(randomPercentage < probabilityThresholds[0])
-        {
-            currentX =   0.85f * currentX + 0.04f * currentY + 0.0f;
-            currentY = -0.04f * currentX + 0.85f * currentY + 1.6f;
-        }
-        else if(randomPercentage < probabilityThresholds[1])
-        {
-            currentX = 0.20 * currentX - 0.26 * currentY + 0.0;
-            currentY = 0.23 * currentX + 0.22 * currentY + 1.6;
-        }
-        else if(randomPercentage < probabilityThresholds[2])
-        {
-            currentX = -0.15 * currentX + 0.28 * currentY + 0.0;
-            currentY = 0.26 * currentX + 0.24 * currentY + 0.44;
-        }
-        else
-        {
-            currentX = 0.00 * currentX + 0.00 * currentY + 0.0;
-            currentY = 0.00 * currentX + 0.16 * currentY + 0.0;
-        }
-        
-        barnsleyFern.verts.push_back(glm::vec3(currentX-0.5f, currentY-1.5f, 1.0f));
-        barnsleyFern.colors.push_back(GOLD_COLOUR);
+    PROFILE_ZONE("generate Barnsley fern");
+    std::shared_ptr<GeneratedLevel> generated = std::make_shared<GeneratedLevel>();
+    std::vector<GeometryData> objects;
+    if (settings.densityMode)
+    {
+        generated->density = makeDensityHistogram();
+        fernGenerator.buildDensity(settings.numberOfIterations, *generated->density);
     }
-
-    RenderingEngine::assignBuffers(barnsleyFern);
-    RenderingEngine::setBufferData(barnsleyFern);
-    objects.push_back(barnsleyFern);
-}
+    else
+    {
+        fernGenerator.build(settings.numberOfIterations, objects);
+    }
+    generated->addObjects(objects);
+    return generated;
+}
 
 void Scene::changeToSierpinskiTriangleScene()
 {
     sceneType = "SIERPINSKI_TRIANGLE_SCENE";
     numberOfIterations = 1;
-    
-    drawAllTriangles();
-}
-    
-void Scene::drawAllTriangles()
-{
-    objects.clear();
-    std::vector<glm::vec3> allTrianglesForIteration;
 
-    allTrianglesForIteration.push_back(glm::vec3(-0.9f, -0.9f, 1.0f));
-    allTrianglesForIteration.push_back(glm::vec3(0.9f, -0.9f, 1.0f));
-    allTrianglesForIteration.push_back(glm::vec3(0.0f, static_cast<float>(sqrt(1.8*1.8-0.9*0.9)/2.0), 1.0f));
+    requestLevel();
+}
 
-    for(int currentIteration = 1; currentIteration < numberOfIterations; currentIteration++)
+std::shared_ptr<GeneratedLevel> Scene::generateAllTriangles(const LevelSettings& settings)
+{
+    PROFILE_ZONE("generate Sierpinski triangles");
+    std::shared_ptr<GeneratedLevel> generated = std::make_shared<GeneratedLevel>();
+    std::vector<GeometryData> objects;
+    if (settings.instancedMode)
     {
-        std::vector<glm::vec3> allTrianglesForNextIteration;
-        for(int i = 0; i < allTrianglesForIteration.size(); i += 3)
-        {
-            glm::vec3 bottomMidpoint = getMidpoint(allTrianglesForIteration[i], allTrianglesForIteration[i+1]);
-            glm::vec3 leftMidpoint = getMidpoint(allTrianglesForIteration[i], allTrianglesForIteration[i+2]);
-            glm::vec3 rightMidpoint = getMidpoint(allTrianglesForIteration[i+1], allTrianglesForIteration[i+2]);
-            allTrianglesForNextIteration.push_back(allTrianglesForIteration[i]);
-            allTrianglesForNextIteration.push_back(bottomMidpoint);
-            allTrianglesForNextIteration.push_back(leftMidpoint);
-            allTrianglesForNextIteration.push_back(bottomMidpoint);
-            allTrianglesForNextIteration.push_back(allTrianglesForIteration[i+1]);
-            allTrianglesForNextIteration.push_back(rightMidpoint);
-            allTrianglesForNextIteration.push_back(leftMidpoint);
-            allTrianglesForNextIteration.push_back(rightMidpoint);
-            allTrianglesForNextIteration.push_back(allTrianglesForIteration[i+2]);
-        }
-        allTrianglesForIteration = allTrianglesForNextIteration;
-    }
-    
-    float currentRed = 1.0f;
-    float currentGreen = 1.0f;
-    float currentBlue = 1.0f;
-    
-    for(int i = 0; i < allTrianglesForIteration.size(); i += 3)
-    {
-        Geometry singleTriangle;
-        singleTriangle.drawMode = GL_TRIANGLES;
-
-        singleTriangle.verts.push_back(allTrianglesForIteration[i]);
-        singleTriangle.verts.push_back(allTrianglesForIteration[i+1]);
-        singleTriangle.verts.push_back(allTrianglesForIteration[i+2]);
-        
-        if(i % 9 == 0)
-        {
-            currentRed -= (9.0f/static_cast<float>(allTrianglesForIteration.size()));
-        }
-        else if(i % 9 == 3)
-        {
-            currentGreen -= (9.0f/static_cast<float>(allTrianglesForIteration.size()));
-        }
-        else if(i % 9 == 6)
-        {
-            currentBlue -= (9.0f/static_cast<float>(allTrianglesForIteration.size()));
-        }
-        
-        singleTriangle.colors.push_back(glm::vec3(currentRed, currentGreen, currentBlue));
-        singleTriangle.colors.push_back(glm::vec3(currentRed, currentGreen, currentBlue));
-        singleTriangle.colors.push_back(glm::vec3(currentRed, currentGreen, currentBlue));
-
-        RenderingEngine::assignBuffers(singleTriangle);
-        RenderingEngine::setBufferData(singleTriangle);
-        objects.push_back(singleTriangle);
+        GeometryBuilder::buildSierpinskiTrianglesInstanced(settings.numberOfIterations, generated->instanced, objects);
     }
+    else
+    {
+        GeometryBuilder::buildSierpinskiTriangles(settings.numberOfIterations, objects);
+    }
+    generated->addObjects(objects);
+    return generated;
 }
 
 void Scene::changeToRandomSierpinskiScene()
 {
     sceneType = "RANDOM_SIERPINSKI_SCENE";
     numberOfIterations = 1;
-    drawRandomSierpinskiTriangle();
+    requestLevel();
 }
 
-void Scene::drawRandomSierpinskiTriangle()
+std::shared_ptr<GeneratedLevel> Scene::generateRandomSierpinskiTriangle(const LevelSettings& settings)
 {
-    objects.clear();
-    int pointsPerIteration = 250;
-    
-    std::vector<glm::vec3> outerTriangle;
-    outerTriangle.push_back(glm::vec3(-0.9f, -0.9f, 1.0f));
-    outerTriangle.push_back(glm::vec3(0.9f, -0.9f, 1.0f));
-    outerTriangle.push_back(glm::vec3(0.0f, static_cast<float>(sqrt(1.8*1.8-0.9*0.9)/2.0), 1.0f));
-    
-    Geometry randomSierpinski;
-    
-    glm::vec3 currentPoint = outerTriangle[0];
-    randomSierpinski.verts.push_back(currentPoint);
-    randomSierpinski.colors.push_back(TEAL_COLOUR);
-    for(int i = 0; i < pointsPerIteration * numberOfIterations; i++)
-    {
-        glm::vec3 nextPoint = getMidpoint(currentPoint, outerTriangle[std::rand()%3]);
-        randomSierpinski.verts.push_back(nextPoint);
-        randomSierpinski.colors.push_back(TEAL_COLOUR);
-        currentPoint = nextPoint;
-    }
-    
-    randomSierpinski.drawMode = GL_POINTS;
-    
-    RenderingEngine::assignBuffers(randomSierpinski);
-    RenderingEngine::setBufferData(randomSierpinski);
-    objects.push_back(randomSierpinski);
+    PROFILE_ZONE("generate random Sierpinski");
+    std::shared_ptr<GeneratedLevel> generated = std::make_shared<GeneratedLevel>();
+    std::vector<GeometryData> objects;
+    if (settings.densityMode)
+    {
+        generated->density = makeDensityHistogram();
+        randomSierpinskiGenerator.buildDensity(settings.numberOfIterations, *generated->density);
+    }
+    else
+    {
+        randomSierpinskiGenerator.build(settings.numberOfIterations, objects);
+    }
+    generated->addObjects(objects);
+    return generated;
 }
 
 void Scene::changeToSpiralScene()
 {
     sceneType = "SPIRAL_SCENE";
     numberOfIterations = 1;
-    
-    drawSpiral();
+
+    requestLevel();
 }
 
-void Scene::drawSpiral()
+std::shared_ptr<GeneratedLevel> Scene::generateSpiral(const LevelSettings& settings)
 {
-    objects.clear();
-    Geometry spiral;
-    int segmentsPerIteration = 50;
-    float du = 1.0f / segmentsPerIteration;
-    for (float u = 0.0f; u < static_cast<float>(numberOfIterations); u += du)
-    {
-        spiral.verts.push_back(glm::vec3((u/numberOfIterations)*cos(2.0f*static_cast<float>(M_PI)*u),
-                                         (u/numberOfIterations)*sin(2.0f*static_cast<float>(M_PI)*u),
-                                         1.0));
-        spiral.colors.push_back(glm::vec3(BLUE_COLOUR[0] + (RED_COLOUR[0] - BLUE_COLOUR[0])*(u/static_cast<float>(numberOfIterations)),
-                                          BLUE_COLOUR[1] + (RED_COLOUR[1] - BLUE_COLOUR[1])*(u/static_cast<float>(numberOfIterations)),
-                                          BLUE_COLOUR[2] + (RED_COLOUR[2] - BLUE_COLOUR[2])*(u/static_cast<float>(numberOfIterations))));
-    }
-    
-    spiral.drawMode = GL_LINE_STRIP;
-    
-    RenderingEngine::assignBuffers(spiral);
-    RenderingEngine::setBufferData(spiral);
-    objects.push_back(spiral);
+    PROFILE_ZONE("generate spiral");
+    std::shared_ptr<GeneratedLevel> generated = std::make_shared<GeneratedLevel>();
+    std::vector<GeometryData> objects;
+    if (settings.pixelsPerUnit > 0.0f)
+    {
+        GeometryBuilder::buildSpiral(settings.numberOfIterations, objects, settings.pixelsPerUnit);
+    }
+    else
+    {
+        GeometryBuilder::buildSpiral(settings.numberOfIterations, objects);
+    }
+    generated->addObjects(objects);
+    return generated;
+}
+
+//Pixels per unit of the framebuffer the scene is drawn to ([-1, 1] spans its smaller side)
+float Scene::getPixelsPerUnit()
+{
+    int width = 0;
+    int height = 0;
+    glfwGetFramebufferSize(glfwGetCurrentContext(), &width, &height);
+    return static_cast<float>(std::min(width, height)) / 2.0f;
 }
 
 void Scene::changeToNestedSquareScene()
 {
     sceneType = "NESTED_SQUARE_SCENE";
     numberOfIterations = 1;
-    
-    drawAllSquares();
+
+    requestLevel();
 }
 
-void Scene::drawAllSquares()
+std::shared_ptr<GeneratedLevel> Scene::generateAllSquares(const LevelSettings& settings)
 {
-    objects.clear();
-    std::vector<glm::vec3> outerSquare;
-    
-    outerSquare.push_back(glm::vec3(-0.9f, 0.9f, 1.0f));
-    outerSquare.push_back(glm::vec3(0.9f, 0.9f, 1.0f));
-    outerSquare.push_back(glm::vec3(0.9f, -0.9f, 1.0f));
-    outerSquare.push_back(glm::vec3(-0.9f, -0.9f, 1.0f));
-    
-    for(int i = 0; i < numberOfIterations; i++)
+    PROFILE_ZONE("generate nested squares");
+    std::shared_ptr<GeneratedLevel> generated = std::make_shared<GeneratedLevel>();
+    std::vector<GeometryData> objects;
+    if (settings.instancedMode)
+    {
+        GeometryBuilder::buildNestedSquaresInstanced(settings.numberOfIterations, generated->instanced, objects);
+    }
+    else
     {
-        outerSquare = drawSingleSquareWithNestedDiamond(outerSquare);
+        nestedSquaresGenerator.build(settings.numberOfIterations, objects);
     }
+    generated->addObjects(objects);
+    return generated;
 }
 
-std::vector<glm::vec3> Scene::drawSingleSquareWithNestedDiamond(
-    std::vector<glm::vec3>& outerSquareVertices)
+Scene::LevelSettings Scene::getLevelSettings()
 {
-    Geometry nestedSquares;
-    nestedSquares.drawMode = GL_LINE_STRIP;
-    drawSquareFinishingAtStartingPointForNextIteration(outerSquareVertices, TEAL_COLOUR,
-        nestedSquares);
-    std::vector<glm::vec3> innerDiamondVertices = getPointsForNextIteration(outerSquareVertices);
-    drawSquareFinishingAtStartingPointForNextIteration(innerDiamondVertices,
-        GOLD_COLOUR, nestedSquares);
-    RenderingEngine::assignBuffers(nestedSquares);
-    RenderingEngine::setBufferData(nestedSquares);
-    objects.push_back(nestedSquares);
-    return getPointsForNextIteration(innerDiamondVertices);
+    LevelSettings settings;
+    settings.sceneType = sceneType;
+    settings.numberOfIterations = numberOfIterations;
+    settings.densityMode = densityMode;
+    settings.instancedMode = instancedMode;
+    settings.randomSeed = randomSeed;
+    settings.pixelsPerUnit = sceneType == "SPIRAL_SCENE" ? getPixelsPerUnit() : 0.0f;
+    return settings;
 }
 
-void Scene::drawSquareFinishingAtStartingPointForNextIteration(
-    std::vector<glm::vec3>& pointsForIteration,
-    const glm::vec3& colourForIteration, Geometry& currentGeometry)
+//Which cached level the settings correspond to. The parameters name only what the scene's
+//geometry depends on, so unrelated toggles keep their entries.
+LevelKey Scene::getLevelKey(const LevelSettings& settings)
 {
-    for(glm::vec3 point: pointsForIteration)
+    LevelKey key;
+    key.scene = settings.sceneType;
+    key.level = settings.numberOfIterations;
+    if (settings.sceneType == "NESTED_SQUARE_SCENE" || settings.sceneType == "SIERPINSKI_TRIANGLE_SCENE" ||
+        settings.sceneType == "HILBERT_CURVE_SCENE")
+    {
+        key.parameters = settings.instancedMode ? "instanced" : "plain";
+    }
+    else if (settings.sceneType == "RANDOM_SIERPINSKI_SCENE" || settings.sceneType == "BARNSLEY_FERN_SCENE")
+    {
+        key.parameters = std::string(settings.densityMode ? "density" : "points") + " seed " +
+            std::to_string(settings.randomSeed);
+    }
+    else if (settings.sceneType == "SPIRAL_SCENE")
     {
-        currentGeometry.verts.push_back(point);
-        currentGeometry.colors.push_back(colourForIteration);
+        key.parameters = std::to_string(settings.pixelsPerUnit) + " pixels per unit";
     }
-    
-    currentGeometry.verts.push_back(pointsForIteration[0]);
-    currentGeometry.colors.push_back(colourForIteration);
-    
-    glm::vec3 startingPointForNextIteration = getMidpoint(pointsForIteration[0], pointsForIteration[1]);
-    currentGeometry.verts.push_back(startingPointForNextIteration);
-    currentGeometry.colors.push_back(colourForIteration);
+    return key;
 }
 
-std::vector<glm::vec3> Scene::getPointsForNextIteration(std::vector<glm::vec3>& pointsForIteration)
+//Shows the current level straight away if it is cached, and otherwise has the worker generate
+//it. The displayed level stays up until the new one is ready.
+void Scene::requestLevel()
 {
-    std::vector<glm::vec3> midpoints;
-    for (int i = 0; i < 3; i++)
+    LevelSettings settings = getLevelSettings();
+    LevelKey key = getLevelKey(settings);
+    requestedKey = key;
+    if (showingLevel && key == displayedKey)
     {
-        midpoints.push_back(getMidpoint(pointsForIteration[i], pointsForIteration[i+1]));
+        levelWorker.cancel();
+        return;
     }
-    midpoints.push_back(getMidpoint(pointsForIteration[3], pointsForIteration[0]));
-    return midpoints;
+
+    std::shared_ptr<const GeneratedLevel> cached = levelCache.find(key);
+    if (cached)
+    {
+        levelWorker.cancel();
+        showLevel(key, *cached);
+        return;
+    }
+
+    levelWorker.submit(key, [this, settings]() -> std::shared_ptr<const GeneratedLevel>
+    {
+        return generateLevel(settings, false);
+    });
 }
 
-glm::vec3 Scene::getMidpoint(glm::vec3& firstPoint, glm::vec3& secondPoint)
+//Queues, for while the viewer is idle, the levels most likely to be asked for next: the ones
+//above and below the displayed level, then the first level of every other scene. Levels
+//already cached, or that may not fit in the cache, are skipped.
+void Scene::prefetchNeighbours()
 {
-    float x1 = firstPoint[0];
-    float y1 = firstPoint[1];
+    LevelSettings settings = getLevelSettings();
+    std::shared_ptr<const GeneratedLevel> displayed = levelCache.find(displayedKey);
+    std::size_t freeBytes = levelCache.getByteBudget() - std::min(levelCache.getByteSize(), levelCache.getByteBudget());
+    if (displayed && displayed->getByteSize() * NEXT_LEVEL_GROWTH <= freeBytes)
+    {
+        LevelSettings next = settings;
+        next.numberOfIterations++;
+        prefetchLevel(next);
+    }
+    if (settings.numberOfIterations > 1)
+    {
+        LevelSettings previous = settings;
+        previous.numberOfIterations--;
+        prefetchLevel(previous);
+    }
 
-    float x2 = secondPoint[0];
-    float y2 = secondPoint[1];
-    
-    return glm::vec3((x1+x2)/2.0f,(y1+y2)/2.0f, 1.0f);
+    for (const char* otherSceneType : SCENE_TYPES)
+    {
+        if (settings.sceneType == otherSceneType)
+        {
+            continue;
+        }
+        LevelSettings other = settings;
+        other.sceneType = otherSceneType;
+        other.numberOfIterations = 1;
+        other.pixelsPerUnit = other.sceneType == "SPIRAL_SCENE" ? getPixelsPerUnit() : 0.0f;
+        prefetchLevel(other);
+    }
 }
-
-void Scene::iterationUp()
+
+void Scene::prefetchLevel(const LevelSettings& settings)
 {
-    if (sceneType == "NESTED_SQUARE_SCENE")
+    //A prefetched level is only any use from the cache
+    LevelKey key = getLevelKey(settings);
+    if (levelCache.contains(key) || levelCache.getByteBudget() == 0)
     {
-        numberOfIterations++;
-        drawAllSquares();
+        return;
     }
-    else if (sceneType == "SPIRAL_SCENE")
+
+    levelWorker.prefetch(key, [this, settings]() -> std::shared_ptr<const GeneratedLevel>
     {
-        numberOfIterations++;
-        drawSpiral();
+        return generateLevel(settings, true);
+    });
+}
+
+//Worker thread: builds the level from the one below it when that is cached and the scene
+//allows it, and from scratch otherwise. Only the worker touches the generators. A prefetched
+//level is only cached if it fits without evicting anything.
+std::shared_ptr<const GeneratedLevel> Scene::generateLevel(const LevelSettings& settings, bool prefetching)
+{
+    PROFILE_ZONE(prefetching ? "prefetch level" : "generate level");
+    LevelKey key = getLevelKey(settings);
+    if (prefetching && levelCache.contains(key))
+    {
+        return std::shared_ptr<const GeneratedLevel>();
     }
-    else if (sceneType == "SIERPINSKI_TRIANGLE_SCENE")
+
+    if (randomSierpinskiGenerator.getSeed() != settings.randomSeed)
     {
-        numberOfIterations++;
-        drawAllTriangles();
+        randomSierpinskiGenerator.setSeed(settings.randomSeed);
     }
-    else if (sceneType == "RANDOM_SIERPINSKI_SCENE")
+    if (fernGenerator.getSeed() != settings.randomSeed)
     {
-        numberOfIterations++;
-        drawRandomSierpinskiTriangle();
+        fernGenerator.setSeed(settings.randomSeed);
     }
-    if (sceneType == "BARNSLEY_FERN_SCENE")
+
+    std::shared_ptr<GeneratedLevel> generated = generateNextLevel(settings);
+    if (!generated)
     {
-        numberOfIterations++;
-        drawBarnsleyFern();
+        ThreadTools::throwIfCancelled();
+        generated = generateFullLevel(settings);
     }
-    if (sceneType == "HILBERT_CURVE_SCENE")
+    if (!generated)
     {
-        numberOfIterations++;
-        drawHilbertCurve();
-    }
-}
-
-void Scene::iterationDown()
+        return generated;
+    }
+
+    if (prefetching)
+    {
+        levelCache.insertIfRoom(key, generated);
+    }
+    else
+    {
+        levelCache.insert(key, generated);
+    }
+    return generated;
+}
+
+std::shared_ptr<GeneratedLevel> Scene::generateFullLevel(const LevelSettings& settings)
+{
+    if (settings.sceneType == "NESTED_SQUARE_SCENE")
+    {
+        return generateAllSquares(settings);
+    }
+    else if (settings.sceneType == "SPIRAL_SCENE")
+    {
+        return generateSpiral(settings);
+    }
+    else if (settings.sceneType == "SIERPINSKI_TRIANGLE_SCENE")
+    {
+        return generateAllTriangles(settings);
+    }
+    else if (settings.sceneType == "RANDOM_SIERPINSKI_SCENE")
+    {
+        return generateRandomSierpinskiTriangle(settings);
+    }
+    else if (settings.sceneType == "BARNSLEY_FERN_SCENE")
+    {
+        return generateBarnsleyFern(settings);
+    }
+    else if (settings.sceneType == "HILBERT_CURVE_SCENE")
+    {
+        return generateHilbertCurve(settings);
+    }
+    return std::shared_ptr<GeneratedLevel>();
+}
+
+//Generates only what the level adds to the cached level below it. Returns null if that level
+//is not cached or the scene cannot be stepped up from it.
+std::shared_ptr<GeneratedLevel> Scene::generateNextLevel(const LevelSettings& settings)
+{
+    PROFILE_ZONE("generate next level");
+    LevelSettings previousSettings = settings;
+    previousSettings.numberOfIterations--;
+    std::shared_ptr<const GeneratedLevel> previous;
+    if (previousSettings.numberOfIterations > 0)
+    {
+        previous = levelCache.find(getLevelKey(previousSettings));
+    }
+    if (!previous)
+    {
+        return std::shared_ptr<GeneratedLevel>();
+    }
+
+    if (settings.sceneType == "NESTED_SQUARE_SCENE" && !settings.instancedMode)
+    {
+        return appendNextLevel(nestedSquaresGenerator, settings.numberOfIterations, *previous);
+    }
+    else if (settings.sceneType == "SIERPINSKI_TRIANGLE_SCENE" && !settings.instancedMode)
+    {
+        return replicateNextLevel(GeometryBuilder::buildSierpinskiTrianglesNextLevel, settings.numberOfIterations, *previous);
+    }
+    else if (settings.sceneType == "RANDOM_SIERPINSKI_SCENE")
+    {
+        if (settings.densityMode)
+        {
+            return appendNextDensityLevel(randomSierpinskiGenerator, settings.numberOfIterations, *previous);
+        }
+        return appendNextLevel(randomSierpinskiGenerator, settings.numberOfIterations, *previous);
+    }
+    else if (settings.sceneType == "BARNSLEY_FERN_SCENE")
+    {
+        if (settings.densityMode)
+        {
+            return appendNextDensityLevel(fernGenerator, settings.numberOfIterations, *previous);
+        }
+        return appendNextLevel(fernGenerator, settings.numberOfIterations, *previous);
+    }
+    else if (settings.sceneType == "HILBERT_CURVE_SCENE" && !settings.instancedMode)
+    {
+        return replicateNextLevel(GeometryBuilder::buildHilbertCurveNextLevel, settings.numberOfIterations, *previous);
+    }
+    return std::shared_ptr<GeneratedLevel>();
+}
+
+bool Scene::update()
+{
+    LevelKey key;
+    std::shared_ptr<const GeneratedLevel> level;
+    double seconds = 0.0;
+    if (levelWorker.takeFinished(key, level, seconds) && key == requestedKey)
+    {
+        generationSeconds += seconds;
+        showLevel(key, *level);
+    }
+
+    if (prefetching && showingLevel && requestedKey == displayedKey && !(prefetchedKey == displayedKey) &&
+        !levelWorker.isBusy())
+    {
+        prefetchNeighbours();
+        prefetchedKey = displayedKey;
+    }
+
+    bool changed = redrawNeeded;
+    redrawNeeded = false;
+    return changed;
+}
+
+void Scene::setLevelDoneCallback(const std::function<void()>& callback)
+{
+    levelWorker.setJobDoneCallback(callback);
+}
+
+void Scene::takeLevelTimes(double& generationSeconds, double& uploadSeconds)
+{
+    generationSeconds = this->generationSeconds;
+    uploadSeconds = this->uploadSeconds;
+    this->generationSeconds = 0.0;
+    this->uploadSeconds = 0.0;
+}
+
+//Swaps the displayed level for another in one go, between frames
+void Scene::showLevel(const LevelKey& key, const GeneratedLevel& level)
+{
+    PROFILE_ZONE("upload level");
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (!uploadNextLevel(key, level))
+    {
+        uploadLevel(level);
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    uploadSeconds += seconds.count();
+    displayedKey = key;
+    showingLevel = true;
+    redrawNeeded = true;
+}
+
+//Shows the level after the displayed one by uploading only what changed: the parts an appending
+//scene added after the displayed ones, or the whole of a replicated level into the existing vbos.
+//Returns false, leaving the scene untouched, if the level does not follow the displayed one.
+bool Scene::uploadNextLevel(const LevelKey& key, const GeneratedLevel& level)
+{
+    if (!showingLevel || showingDensity || level.density || !level.instanced.transforms.empty() ||
+        displayedPartCount == 0 || level.parts.size() < displayedPartCount || key.scene != displayedKey.scene ||
+        key.parameters != displayedKey.parameters || key.level != displayedKey.level + 1)
+    {
+        return false;
+    }
+
+    if (isAppendingScene(key.scene))
+    {
+        //Only a level stepped up from the displayed one starts with its parts
+        if (level.parts[displayedPartCount - 1].data != lastDisplayedPart)
+        {
+            return false;
+        }
+
+        std::vector<size_t> firstNewVertices;
+        for (const Geometry& geometry : objects)
+        {
+            firstNewVertices.push_back(geometry.getVertexCount());
+        }
+
+        //The last object is always the final range of its batch, so parts carrying it on grow it in place
+        for (size_t i = displayedPartCount; i < level.parts.size(); i++)
+        {
+            lastObjectBatch = batchObject(level.parts[i]);
+        }
+        displayedPartCount = level.parts.size();
+        lastDisplayedPart = level.parts.back().data;
+
+        for (size_t i = 0; i < objects.size(); i++)
+        {
+            if (i >= firstNewVertices.size())
+            {
+                RenderingEngine::setBufferData(objects[i]);
+            }
+            else if (objects[i].getVertexCount() > firstNewVertices[i])
+            {
+                RenderingEngine::appendBufferData(objects[i], firstNewVertices[i]);
+            }
+        }
+        return true;
+    }
+
+    if (objects.size() != 1 || displayedPartCount != 1 || level.parts.size() != 1)
+    {
+        return false;
+    }
+    objects[0].sharedVertices.clear();
+    shareVertices(objects[0], level.parts[0].data);
+    lastDisplayedPart = level.parts[0].data;
+    objects[0].vertexCounts[0] = objects[0].getVertexCount();
+    RenderingEngine::setBufferData(objects[0]);
+    return true;
+}
+
+void Scene::uploadLevel(const GeneratedLevel& level)
 {
-    if (sceneType == "NESTED_SQUARE_SCENE")
+    if (level.density)
+    {
+        densityHistogram = *level.density;
+        uploadDensity();
+    }
+    else if (!level.instanced.transforms.empty())
     {
-        decrementNumberOfIterations();
-        drawAllSquares();
+        uploadInstanced(level.instanced, level.parts);
     }
-    else if (sceneType == "SPIRAL_SCENE")
+    else
     {
-        decrementNumberOfIterations();
-        drawSpiral();
+        uploadObjects(level.parts);
     }
-    else if (sceneType == "SIERPINSKI_TRIANGLE_SCENE")
+}
+
+//Upload stage: copies the generated buffers to the GPU and keeps them as the displayed objects,
+//merged into one batch per draw mode so the renderer draws each batch with a single call
+void Scene::uploadObjects(const std::vector<LevelPart>& generated)
+{
+    showingDensity = false;
+    clearObjects();
+    for (const LevelPart& part : generated)
     {
-        decrementNumberOfIterations();
-        drawAllTriangles();
+        lastObjectBatch = batchObject(part);
     }
-    else if (sceneType == "RANDOM_SIERPINSKI_SCENE")
+    displayedPartCount = generated.size();
+    lastDisplayedPart = generated.empty() ? std::shared_ptr<const GeometryData>() : generated.back().data;
+
+    for (Geometry& geometry : objects)
     {
-        decrementNumberOfIterations();
-        drawRandomSierpinskiTriangle();
+        RenderingEngine::setBufferData(geometry);
     }
-    else if (sceneType == "BARNSLEY_FERN_SCENE")
+}
+
+//Appends an object's vertices to the batch drawn with its draw mode, starting a batch if there is none.
+//Every object in a scene shares its vertex layout, so the draw mode is all that separates batches.
+//A part carrying on the last object extends its range instead. Batches refer to the parts rather
+//than copying them, so a shown level is held on the CPU once, by the level cache.
+//Returns the index of the batch; its vbos still need uploading.
+size_t Scene::batchObject(const LevelPart& part)
+{
+    const GeometryData& data = *part.data;
+    if (part.continuesObject && !objects.empty())
+    {
+        Geometry& geometry = objects[lastObjectBatch];
+        geometry.vertexCounts.back() += data.verts.size();
+        shareVertices(geometry, part.data);
+        return lastObjectBatch;
+    }
+
+    GLuint drawMode = RenderingEngine::getDrawMode(data.primitive);
+    size_t batch = 0;
+    while (batch < objects.size() && (objects[batch].instanceCount > 0 || objects[batch].drawMode != drawMode))
+    {
+        batch++;
+    }
+
+    if (batch == objects.size())
+    {
+        Geometry geometry;
+        geometry.drawMode = drawMode;
+        geometry.layout = getVertexLayout(sceneType);
+        RenderingEngine::assignBuffers(geometry);
+        objects.push_back(geometry);
+    }
+
+    Geometry& geometry = objects[batch];
+    geometry.firstVertices.push_back(geometry.getVertexCount());
+    geometry.vertexCounts.push_back(data.verts.size());
+    shareVertices(geometry, part.data);
+    return batch;
+}
+
+//Uploads the base geometry once with its instance transforms, then anything drawn uninstanced
+void Scene::uploadInstanced(const InstancedGeometryData& instanced, const std::vector<LevelPart>& generated)
+{
+    uploadObjects(generated);
+
+    Geometry geometry;
+    geometry.verts = instanced.base.verts;
+    geometry.colors = instanced.base.colors;
+    geometry.drawMode = RenderingEngine::getDrawMode(instanced.base.primitive);
+    //The base is a handful of vertices, so it keeps full float positions
+    geometry.layout = VertexLayouts::COMPACT;
+
+    RenderingEngine::assignBuffers(geometry);
+    RenderingEngine::setBufferData(geometry);
+    RenderingEngine::assignInstanceBuffer(geometry);
+    RenderingEngine::setInstanceData(geometry, instanced.transforms, instanced.colourOffsets);
+    objects.insert(objects.begin(), geometry);
+    lastObjectBatch++;
+}
+
+//Hands the buffers of the displayed objects back to the renderer's pool for the next upload
+void Scene::clearObjects()
+{
+    for (Geometry& geometry : objects)
     {
-        decrementNumberOfIterations();
-        drawBarnsleyFern();
+        RenderingEngine::deleteBufferData(geometry);
     }
-    else if (sceneType == "HILBERT_CURVE_SCENE")
+    objects.clear();
+    displayedPartCount = 0;
+    lastDisplayedPart.reset();
+}
+
+void Scene::uploadDensity()
+{
+    clearObjects();
+    if (!densityTexture)
     {
-        decrementNumberOfIterations();
-        drawHilbertCurve();
-    }
+        RenderingEngine::assignDensityTexture(densityTexture);
+    }
+    RenderingEngine::setDensityTextureData(densityTexture, densityHistogram);
+    showingDensity = true;
+}
+
+MemoryReport Scene::getMemoryReport() const
+{
+    MemoryReport report(showingLevel ? getLevelName(displayedKey) : "no level shown");
+    GpuBufferPool& pool = RenderingEngine::getBufferPool();
+
+    size_t vertexCpuBytes = 0, vertexGpuBytes = 0;
+    size_t colourCpuBytes = 0, colourGpuBytes = 0;
+    size_t rangeCpuBytes = 0, rangeCount = 0;
+    size_t instanceCpuBytes = 0, instanceGpuBytes = 0, instancedObjects = 0;
+    size_t vertexArrays = 0;
+    //Parts the objects draw from that the cache has let go of, so only the display holds them
+    size_t uncachedPartBytes = 0, uncachedParts = 0;
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        const Geometry& geometry = objects[i];
+        for (const Geometry::SharedVertices& shared : geometry.sharedVertices)
+        {
+            if (!levelCache.holdsBuffer(shared.owner.get()))
+            {
+                const GeometryData& data = *static_cast<const GeometryData*>(shared.owner.get());
+                uncachedPartBytes += (data.verts.capacity() + data.colors.capacity()) * sizeof(glm::vec3);
+                uncachedParts++;
+            }
+        }
+        vertexCpuBytes += geometry.verts.capacity() * sizeof(glm::vec3) +
+            geometry.normals.capacity() * sizeof(glm::vec3) + geometry.uvs.capacity() * sizeof(glm::vec2);
+        vertexGpuBytes += pool.getCapacity(geometry.vertexBuffer) + pool.getCapacity(geometry.normalBuffer) +
+            pool.getCapacity(geometry.uvBuffer);
+        colourCpuBytes += geometry.colors.capacity() * sizeof(glm::vec3);
+        colourGpuBytes += pool.getCapacity(geometry.colorBuffer);
+        rangeCpuBytes += geometry.firstVertices.capacity() * sizeof(GLint) +
+            geometry.vertexCounts.capacity() * sizeof(GLsizei);
+        rangeCount += geometry.vertexCounts.size();
+        instanceCpuBytes += geometry.instanceTransforms.capacity() * sizeof(glm::mat3) +
+            geometry.instanceColourOffsets.capacity() * sizeof(glm::vec3);
+        instanceGpuBytes += pool.getCapacity(geometry.instanceBuffer);
+        instancedObjects += (geometry.instanceCount > 0) ? 1 : 0;
+        vertexArrays += geometry.vao ? 1 : 0;
+
+        std::ostringstream name;
+        name << "object " << i << ": " << geometry.getVertexCount() << " vertices of " << getDrawModeName(geometry.drawMode);
+        if (geometry.instanceCount > 0)
+        {
+            name << ", " << geometry.instanceCount << " instances";
+        }
+        else if (geometry.vertexCounts.size() > 1)
+        {
+            name << " in " << geometry.vertexCounts.size() << " ranges";
+        }
+        report.add(MemoryReport::OBJECT, name.str(), geometry.getCpuByteSize(),
+            RenderingEngine::getGpuByteSize(geometry), 1);
+    }
+
+    report.add(MemoryReport::CATEGORY, "vertex data", vertexCpuBytes, vertexGpuBytes, objects.size());
+    report.add(MemoryReport::CATEGORY, "colour data", colourCpuBytes, colourGpuBytes, objects.size());
+    report.add(MemoryReport::CATEGORY, "draw ranges", rangeCpuBytes, 0, rangeCount);
+    report.add(MemoryReport::CATEGORY, "shown parts outside the cache", uncachedPartBytes, 0, uncachedParts);
+    report.add(MemoryReport::CATEGORY, "instance data", instanceCpuBytes, instanceGpuBytes, instancedObjects);
+    report.add(MemoryReport::CATEGORY, "vertex arrays", 0, 0, vertexArrays);
+    report.add(MemoryReport::CATEGORY, "density histogram", densityHistogram.getByteSize(),
+        densityTexture ? RenderingEngine::getDensityTextureByteSize(densityHistogram) : 0, densityTexture ? 1 : 0);
+
+    std::vector<std::pair<LevelKey, size_t> > cachedLevels = levelCache.getEntrySizes();
+    report.add(MemoryReport::CATEGORY, "level cache", levelCache.getByteSize(), 0, cachedLevels.size());
+    for (const std::pair<LevelKey, size_t>& cached : cachedLevels)
+    {
+        report.add(MemoryReport::CACHED_LEVEL, getLevelName(cached.first), cached.second, 0, 1);
+    }
+
+    report.add(MemoryReport::CATEGORY, "pooled free buffers", 0, pool.getPooledBytes(), pool.getPooledBufferCount());
+    GLsizeiptr ringBytes = RenderingEngine::getUploadRing().getByteSize();
+    report.add(MemoryReport::CATEGORY, "upload ring", 0, ringBytes, ringBytes ? 1 : 0);
+    return report;
+}
+
+void Scene::printMemoryReport() const
+{
+    getMemoryReport().print(std::cout);
+}
+
+void Scene::toggleDensityMode()
+{
+    densityMode = !densityMode;
+    requestLevel();
+}
+
+void Scene::toggleInstancedMode()
+{
+    instancedMode = !instancedMode;
+    requestLevel();
+}
+
+void Scene::reseedRandomScenes()
+{
+    randomSeed++;
+    requestLevel();
+    std::cout << "Random seed " << randomSeed << std::endl;
+}
+
+void Scene::iterationUp()
+{
+    numberOfIterations++;
+    requestLevel();
+}
+
+void Scene::iterationDown()
+{
+    decrementNumberOfIterations();
+    requestLevel();
 }
 
 void Scene::decrementNumberOfIterations()
@@ -512,6 +920,13 @@ void Scene::decrementNumberOfIterations()
 
 void Scene::displayScene()
 {
-	renderer->RenderScene(objects);
+    PROFILE_ZONE("draw scene");
+    if (showingDensity)
+    {
+        renderer->RenderDensity(densityTexture, densityHistogram);
+    }
+    else
+    {
+        renderer->RenderScene(objects);
+    }
 }
-
@@ -8,6 +8,8 @@
 #ifndef SCENE_H_
 #define SCENE_H_
 
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <string>
 
@@ -16,6 +18,11 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "Geometry.h"
+#include "GeometryBuilder.h"
+#include "DensityHistogram.h"
+#include "LevelCache.h"
+#include "LevelWorker.h"
+#include "MemoryReport.h"
 
 //Forward declaration of classes
 //(note this is necessary because these are pointers and it allows the #include to appear in the .cpp file)
@@ -23,9 +30,33 @@ class RenderingEngine;
 
 class Scene {
 public:
-	Scene(RenderingEngine* renderer);
+	//levelCacheBudget is the memory, in bytes, recently shown levels may be kept in
+	Scene(RenderingEngine* renderer, std::size_t levelCacheBudget);
 	virtual ~Scene();
 
+	//Shows the level the worker has finished generating, if it is still the one wanted, and
+	//prefetches the likely next levels once it is idle. Call once per loop, before displayScene.
+	//Returns whether what the scene shows has changed since it was last drawn.
+	bool update();
+
+	//Called (on the worker thread) whenever the worker finishes a job, so a caller waiting for
+	//events knows to call update again
+	void setLevelDoneCallback(const std::function<void()>& callback);
+
+	//Whether levels are generated ahead of time while idle. Off for replays, as a prefetch
+	//still running when the next key is replayed would make its timing vary from run to run.
+	void setPrefetching(bool enabled) { prefetching = enabled; }
+
+	//Whether the level last asked for is the one shown, so nothing is left to generate or upload
+	bool isLevelShown() const { return showingLevel && requestedKey == displayedKey; }
+
+	//Seconds spent generating and uploading the levels shown since the last call
+	void takeLevelTimes(double& generationSeconds, double& uploadSeconds);
+
+	//CPU and GPU memory held for the displayed level, the level cache and the renderer's buffers
+	MemoryReport getMemoryReport() const;
+	void printMemoryReport() const;
+
 	//Send geometry to the renderer
 	void displayScene();
 	void changeToTriangleScene();
@@ -41,24 +72,55 @@ public:
 	void iterationUp();
 	void iterationDown();
 
+	//Switches the chaos-game scenes between drawing every point and drawing a density histogram
+	void toggleDensityMode();
+
+	//Switches the self-similar scenes between uploading every vertex and drawing copies of a small base
+	void toggleInstancedMode();
+
+	//Moves the random scenes on to the next seed and redraws them
+	void reseedRandomScenes();
+
 private:
-    void drawAllSquares();
-    void drawSpiral();
-    void drawAllTriangles();
-    void drawRandomSierpinskiTriangle();
-    void drawBarnsleyFern();
-    void drawHilbertCurve();
-    
-    void drawSquareFinishingAtStartingPointForNextIteration(std::vector<glm::vec3>& pointsForIteration,
-        const glm::vec3& colourForIteration, Geometry& currentGeometry);
-    std::vector<glm::vec3> getPointsForNextIteration(std::vector<glm::vec3>& pointsForIteration);
-    glm::vec3 getMidpoint(glm::vec3& firstPoint, glm::vec3& secondPoint);
-    std::vector<glm::vec3> drawSingleSquareWithNestedDiamond(std::vector<glm::vec3>& outerSquareVertices);
+    //What a level is generated from, captured on the main thread so the worker never reads the scene
+    struct LevelSettings
+    {
+        std::string sceneType;
+        int numberOfIterations;
+        bool densityMode;
+        bool instancedMode;
+        std::uint64_t randomSeed;
+        float pixelsPerUnit;
+    };
+
+    LevelSettings getLevelSettings();
+    static LevelKey getLevelKey(const LevelSettings& settings);
+    float getPixelsPerUnit();
+    void requestLevel();
+    void prefetchNeighbours();
+    void prefetchLevel(const LevelSettings& settings);
+
+    //Generation stage, run on the worker thread
+    std::shared_ptr<const GeneratedLevel> generateLevel(const LevelSettings& settings, bool prefetching);
+    std::shared_ptr<GeneratedLevel> generateNextLevel(const LevelSettings& settings);
+    std::shared_ptr<GeneratedLevel> generateFullLevel(const LevelSettings& settings);
+    std::shared_ptr<GeneratedLevel> generateAllSquares(const LevelSettings& settings);
+    std::shared_ptr<GeneratedLevel> generateSpiral(const LevelSettings& settings);
+    std::shared_ptr<GeneratedLevel> generateAllTriangles(const LevelSettings& settings);
+    std::shared_ptr<GeneratedLevel> generateRandomSierpinskiTriangle(const LevelSettings& settings);
+    std::shared_ptr<GeneratedLevel> generateBarnsleyFern(const LevelSettings& settings);
+    std::shared_ptr<GeneratedLevel> generateHilbertCurve(const LevelSettings& settings);
+
+    //Upload stage, run on the main thread
+    void showLevel(const LevelKey& key, const GeneratedLevel& level);
+    bool uploadNextLevel(const LevelKey& key, const GeneratedLevel& level);
+    void uploadLevel(const GeneratedLevel& level);
+    void uploadObjects(const std::vector<LevelPart>& generated);
+    size_t batchObject(const LevelPart& part);
+    void uploadInstanced(const InstancedGeometryData& instanced, const std::vector<LevelPart>& generated);
+    void uploadDensity();
+    void clearObjects();
     void decrementNumberOfIterations();
-    void hilbertA(glm::vec3& currentPosition, int currentLevel, float segmentLength, Geometry& hilbertCurve);
-    void hilbertB(glm::vec3& currentPosition, int currentLevel, float segmentLength, Geometry& hilbertCurve);
-    void hilbertC(glm::vec3& currentPosition, int currentLevel, float segmentLength, Geometry& hilbertCurve);
-    void hilbertD(glm::vec3& currentPosition, int currentLevel, float segmentLength, Geometry& hilbertCurve);
     
 private:
     int numberOfIterations;
@@ -66,8 +128,50 @@ private:
 	RenderingEngine* renderer;
 	std::string sceneType;
 
-	//list of objects in the scene
+	//list of objects in the scene, batched by draw mode
 	std::vector<Geometry> objects;
+
+	//How many level parts the batches hold, the batch holding the last object, and the last part
+	//(which a level stepped up from the displayed one shares)
+	size_t displayedPartCount;
+	size_t lastObjectBatch;
+	std::shared_ptr<const GeometryData> lastDisplayedPart;
+
+	//Seed of the random scenes
+	std::uint64_t randomSeed;
+
+	//Generators that remember their last level, so stepping up only builds the new part.
+	//Only used on the worker thread.
+	GeometryBuilder::NestedSquaresGenerator nestedSquaresGenerator;
+	GeometryBuilder::RandomSierpinskiGenerator randomSierpinskiGenerator;
+	GeometryBuilder::BarnsleyFernGenerator fernGenerator;
+
+	//Density rendering of the chaos-game scenes
+	bool densityMode;
+	bool showingDensity;
+	DensityHistogram densityHistogram;
+	GLuint densityTexture;
+
+	//Instanced rendering of the self-similar scenes
+	bool instancedMode;
+
+	//Recently shown levels, so revisiting one skips generation
+	LevelCache levelCache;
+
+	//Level last asked for, the one on screen, and the last one whose neighbours were prefetched
+	LevelKey requestedKey;
+	LevelKey displayedKey;
+	bool showingLevel;
+	bool redrawNeeded;
+
+	//Time spent on the levels shown since takeLevelTimes was last called
+	double generationSeconds;
+	double uploadSeconds;
+	LevelKey prefetchedKey;
+	bool prefetching;
+
+	//Declared last so it is stopped before anything its jobs use is destroyed
+	LevelWorker levelWorker;
 };
 
 #endif /* SCENE_H_ */
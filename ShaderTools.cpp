@@ -87,9 +87,13 @@ GLuint ShaderTools::LinkProgram(GLuint vertexShader, GLuint fragmentShader) {
 }
 
 GLuint ShaderTools::InitializeShaders() {
+	return InitializeShaders("shaders/vertex.glsl", "shaders/fragment.glsl");
+}
+
+GLuint ShaderTools::InitializeShaders(const std::string &vertexFile, const std::string &fragmentFile) {
 	// load shader source from files
-	std::string vertexSource = LoadSource("shaders/vertex.glsl");
-	std::string fragmentSource = LoadSource("shaders/fragment.glsl");
+	std::string vertexSource = LoadSource(vertexFile);
+	std::string fragmentSource = LoadSource(fragmentFile);
 	if (vertexSource.empty() || fragmentSource.empty()) return false;
 
 	// compile shader source into shader objects
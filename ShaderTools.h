@@ -25,6 +25,9 @@ namespace ShaderTools {
 	GLuint LinkProgram(GLuint vertexShader, GLuint fragmentShader);
 
 	GLuint InitializeShaders();
+
+	// loads, compiles and links the given vertex and fragment shader files
+	GLuint InitializeShaders(const std::string &vertexFile, const std::string &fragmentFile);
 }
 
 #endif /* SHADERTOOLS_H_ */
@@ -0,0 +1,512 @@
+/*
+ * SoftwareRasterizer.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "SoftwareRasterizer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+
+#include "ThreadTools.h"
+
+#if defined(__SSE2__)
+#define RASTERIZER_SSE_EDGES
+#include <emmintrin.h>
+#endif
+
+namespace {
+	//Work below these sizes stays on one thread
+	const std::size_t VERTEX_MINIMUM_SLICE = 65536;
+	const std::size_t BIN_MINIMUM_SLICE = 65536;
+	const std::size_t DENSITY_MINIMUM_ROWS = 64;
+
+	std::uint32_t packColour(const glm::vec3& colour) {
+		std::uint32_t packed = 0xFF000000u;
+		for (int channel = 0; channel < 3; channel++) {
+			float value = std::min(std::max(colour[channel], 0.0f), 1.0f);
+			packed |= (std::uint32_t)(value * 255.0f + 0.5f) << (8 * channel);
+		}
+		return packed;
+	}
+
+	//Channels of a packed colour as floats in [0, 255]
+	void unpackColour(std::uint32_t colour, float channels[3]) {
+		for (int channel = 0; channel < 3; channel++) {
+			channels[channel] = (float)((colour >> (8 * channel)) & 0xFF);
+		}
+	}
+
+	std::uint32_t packChannels(float red, float green, float blue) {
+		float channels[3] = { red, green, blue };
+		std::uint32_t packed = 0xFF000000u;
+		for (int channel = 0; channel < 3; channel++) {
+			float value = std::min(std::max(channels[channel], 0.0f), 255.0f);
+			packed |= (std::uint32_t)(value + 0.5f) << (8 * channel);
+		}
+		return packed;
+	}
+
+	std::uint32_t mixColours(const float from[3], const float to[3], float t) {
+		return packChannels(from[0] + (to[0] - from[0]) * t, from[1] + (to[1] - from[1]) * t,
+			from[2] + (to[2] - from[2]) * t);
+	}
+
+	//Coefficients of the edge function A*x + B*y + C of the edge from a to b, which is positive
+	//to the left of it, and equal at any point to twice the area of the triangle a, b, point
+	struct Edge {
+		Edge(float ax, float ay, float bx, float by) : a(ay - by), b(bx - ax), c(ax * by - ay * bx) {}
+
+		float evaluate(float x, float y) const { return a * x + b * y + c; }
+
+		float a;
+		float b;
+		float c;
+	};
+}
+
+SoftwareRasterizer::SoftwareRasterizer() : width(0), height(0), tilesX(0), tilesY(0) {
+}
+
+void SoftwareRasterizer::resize(int width, int height) {
+	if (width == this->width && height == this->height) {
+		return;
+	}
+	this->width = std::max(width, 0);
+	this->height = std::max(height, 0);
+	tilesX = (this->width + TILE_SIZE - 1) / TILE_SIZE;
+	tilesY = (this->height + TILE_SIZE - 1) / TILE_SIZE;
+	pixels.assign((std::size_t)this->width * this->height, 0xFF000000u);
+}
+
+void SoftwareRasterizer::clear(const glm::vec3& colour) {
+	std::fill(pixels.begin(), pixels.end(), packColour(colour));
+}
+
+void SoftwareRasterizer::draw(const std::vector<Geometry>& objects) {
+	vertices.clear();
+	runs.clear();
+	glm::vec3 noOffset(0.0f);
+	for (const Geometry& geometry : objects) {
+		if (geometry.instanceCount > 0) {
+			std::size_t instances = std::min(geometry.instanceTransforms.size(), geometry.instanceColourOffsets.size());
+			for (std::size_t instance = 0; instance < instances; instance++) {
+				std::uint32_t first = vertices.size();
+				addVertices(geometry, &geometry.instanceTransforms[instance], geometry.instanceColourOffsets[instance]);
+				addPrimitives(geometry.drawMode, first, geometry.getVertexCount());
+			}
+			continue;
+		}
+
+		std::uint32_t first = vertices.size();
+		addVertices(geometry, 0, noOffset);
+		if (geometry.vertexCounts.size() > 1) {
+			for (std::size_t range = 0; range < geometry.vertexCounts.size(); range++) {
+				addPrimitives(geometry.drawMode, first + geometry.firstVertices[range], geometry.vertexCounts[range]);
+			}
+		} else {
+			addPrimitives(geometry.drawMode, first, geometry.getVertexCount());
+		}
+	}
+
+	binPrimitives();
+
+	//Tiles are handed out one at a time, as some hold far more than others
+	std::atomic<int> nextTile(0);
+	int tileCount = tilesX * tilesY;
+	ThreadTools::parallelFor(ThreadTools::getWorkerCount(), 1,
+		[this, &nextTile, tileCount](std::size_t, std::size_t, unsigned int) {
+			for (int tile = nextTile++; tile < tileCount; tile = nextTile++) {
+				rasterizeTile(tile);
+			}
+		});
+}
+
+void SoftwareRasterizer::addVertices(const Geometry& geometry, const glm::mat3* transform, const glm::vec3& colourOffset) {
+	std::size_t first = vertices.size();
+	std::size_t count = geometry.getVertexCount();
+	vertices.resize(first + count);
+
+	ScreenVertex* out = vertices.data() + first;
+	float halfWidth = 0.5f * width;
+	float halfHeight = 0.5f * height;
+	ThreadTools::parallelFor(count, VERTEX_MINIMUM_SLICE,
+		[=, &geometry, &colourOffset](std::size_t begin, std::size_t end, unsigned int) {
+			geometry.forEachVertexRun(begin, end - begin,
+				[=, &colourOffset](const glm::vec3* verts, const glm::vec3* colors, std::size_t runCount, std::size_t index) {
+					ScreenVertex* runOut = out + begin + index;
+					for (std::size_t i = 0; i < runCount; i++) {
+						glm::vec3 position = verts[i];
+						if (transform) {
+							position = (*transform) * glm::vec3(position.x, position.y, 1.0f);
+						}
+						runOut[i].x = (position.x + 1.0f) * halfWidth;
+						runOut[i].y = (position.y + 1.0f) * halfHeight;
+						runOut[i].colour = packColour((colors ? colors[i] : glm::vec3(1.0f)) + colourOffset);
+					}
+				});
+		});
+}
+
+void SoftwareRasterizer::addPrimitives(GLuint drawMode, std::uint32_t first, std::uint32_t count) {
+	//Vertices past what a tile entry can index are not drawn
+	if (first > VERTEX_MASK) {
+		return;
+	}
+	count = std::min(count, VERTEX_MASK + 1 - first);
+
+	PrimitiveRun run = { first, 0, 1, POINT_PRIMITIVE };
+	switch (drawMode) {
+	case GL_POINTS:
+		run.count = count;
+		break;
+	case GL_LINES:
+		run.count = count / 2;
+		run.stride = 2;
+		run.kind = LINE_PRIMITIVE;
+		break;
+	case GL_LINE_STRIP:
+		run.count = count > 1 ? count - 1 : 0;
+		run.kind = LINE_PRIMITIVE;
+		break;
+	case GL_TRIANGLES:
+		run.count = count / 3;
+		run.stride = 3;
+		run.kind = TRIANGLE_PRIMITIVE;
+		break;
+	default:
+		break;
+	}
+	if (run.count > 0) {
+		runs.push_back(run);
+	}
+}
+
+void SoftwareRasterizer::getPixelBounds(std::uint32_t first, int vertexCount, int& minX, int& minY, int& maxX,
+	int& maxY) const {
+	const ScreenVertex* corners = &vertices[first];
+	float lowX = corners[0].x, highX = corners[0].x;
+	float lowY = corners[0].y, highY = corners[0].y;
+	for (int i = 1; i < vertexCount; i++) {
+		lowX = std::min(lowX, corners[i].x);
+		highX = std::max(highX, corners[i].x);
+		lowY = std::min(lowY, corners[i].y);
+		highY = std::max(highY, corners[i].y);
+	}
+
+	//Clamped as floats first, so far off-screen coordinates cannot overflow an int
+	minX = (int)std::floor(std::max(lowX, 0.0f));
+	minY = (int)std::floor(std::max(lowY, 0.0f));
+	maxX = (int)std::floor(std::min(highX, (float)width - 1.0f));
+	maxY = (int)std::floor(std::min(highY, (float)height - 1.0f));
+	if (highX < 0.0f || highY < 0.0f || lowX >= width || lowY >= height) {
+		maxX = minX - 1;
+	}
+}
+
+void SoftwareRasterizer::binPrimitives() {
+	std::size_t slices = ThreadTools::getWorkerCount();
+	std::size_t tileCount = (std::size_t)tilesX * tilesY;
+	bins.resize(std::max(bins.size(), slices));
+	for (std::vector<std::vector<std::uint32_t> >& slice : bins) {
+		slice.resize(tileCount);
+		for (std::vector<std::uint32_t>& tile : slice) {
+			tile.clear();
+		}
+	}
+
+	//Split by first vertex, so each slice takes the runs that start primitives in its range
+	ThreadTools::parallelFor(vertices.size(), BIN_MINIMUM_SLICE,
+		[this](std::size_t begin, std::size_t end, unsigned int slice) {
+			PrimitiveRun after = { (std::uint32_t)begin, 0, 1, 0 };
+			std::vector<PrimitiveRun>::const_iterator run = std::upper_bound(runs.begin(), runs.end(), after,
+				[](const PrimitiveRun& a, const PrimitiveRun& b) { return a.first < b.first; });
+			if (run != runs.begin()) {
+				--run;
+			}
+			for (; run != runs.end() && run->first < end; ++run) {
+				binRun(*run, begin, end, bins[slice]);
+			}
+		});
+}
+
+void SoftwareRasterizer::binRun(const PrimitiveRun& run, std::size_t begin, std::size_t end,
+	std::vector<std::vector<std::uint32_t> >& sliceBins) const {
+	std::size_t primitive = begin > run.first ? (begin - run.first + run.stride - 1) / run.stride : 0;
+	std::size_t first = run.first + primitive * run.stride;
+	std::uint32_t kindBits = run.kind << KIND_SHIFT;
+
+	if (run.kind == POINT_PRIMITIVE) {
+		for (; primitive < run.count && first < end; primitive++, first++) {
+			const ScreenVertex& point = vertices[first];
+			//Also false for NaN, and checked as floats so far off-screen points cannot overflow an int
+			if (!(point.x >= 0.0f && point.x < width && point.y >= 0.0f && point.y < height)) {
+				continue;
+			}
+			int tileX = (int)point.x / TILE_SIZE;
+			int tileY = (int)point.y / TILE_SIZE;
+			sliceBins[tileY * tilesX + tileX].push_back(kindBits | (std::uint32_t)first);
+		}
+		return;
+	}
+
+	int vertexCount = (run.kind == TRIANGLE_PRIMITIVE) ? 3 : 2;
+	for (; primitive < run.count && first < end; primitive++, first += run.stride) {
+		int minX, minY, maxX, maxY;
+		getPixelBounds(first, vertexCount, minX, minY, maxX, maxY);
+		if (maxX < minX || maxY < minY) {
+			continue;
+		}
+
+		for (int tileY = minY / TILE_SIZE; tileY <= maxY / TILE_SIZE; tileY++) {
+			for (int tileX = minX / TILE_SIZE; tileX <= maxX / TILE_SIZE; tileX++) {
+				sliceBins[tileY * tilesX + tileX].push_back(kindBits | (std::uint32_t)first);
+			}
+		}
+	}
+}
+
+void SoftwareRasterizer::rasterizeTile(int tile) {
+	int minX = (tile % tilesX) * TILE_SIZE;
+	int minY = (tile / tilesX) * TILE_SIZE;
+	int maxX = std::min(width, minX + TILE_SIZE) - 1;
+	int maxY = std::min(height, minY + TILE_SIZE) - 1;
+
+	for (const std::vector<std::vector<std::uint32_t> >& slice : bins) {
+		for (std::uint32_t entry : slice[tile]) {
+			std::uint32_t first = entry & VERTEX_MASK;
+			switch (entry >> KIND_SHIFT) {
+			case POINT_PRIMITIVE:
+				drawPoint(first, minX, minY, maxX, maxY);
+				break;
+			case LINE_PRIMITIVE:
+				drawLine(first, minX, minY, maxX, maxY);
+				break;
+			case TRIANGLE_PRIMITIVE:
+				drawTriangle(first, minX, minY, maxX, maxY);
+				break;
+			}
+		}
+	}
+}
+
+void SoftwareRasterizer::drawPoint(std::uint32_t first, int minX, int minY, int maxX, int maxY) {
+	const ScreenVertex& point = vertices[first];
+	int x = (int)std::floor(point.x);
+	int y = (int)std::floor(point.y);
+	if (x >= minX && x <= maxX && y >= minY && y <= maxY) {
+		pixels[(std::size_t)y * width + x] = point.colour;
+	}
+}
+
+//Steps along the longer axis, one pixel centre at a time, and lights the pixel the line
+//crosses there. Centres from the start up to but not including the end are drawn, so the
+//lines of a strip meet without gaps.
+void SoftwareRasterizer::drawLine(std::uint32_t first, int minX, int minY, int maxX, int maxY) {
+	const ScreenVertex& start = vertices[first];
+	const ScreenVertex& end = vertices[first + 1];
+	float startColour[3], endColour[3];
+	unpackColour(start.colour, startColour);
+	unpackColour(end.colour, endColour);
+	bool flat = start.colour == end.colour;
+
+	float dx = end.x - start.x;
+	float dy = end.y - start.y;
+	bool alongX = std::fabs(dx) >= std::fabs(dy);
+	float major = alongX ? dx : dy;
+	if (major == 0.0f) {
+		return;
+	}
+
+	float majorStart = alongX ? start.x : start.y;
+	float minorStart = alongX ? start.y : start.x;
+	float slope = (alongX ? dy : dx) / major;
+	float low = std::min(majorStart, majorStart + major);
+	float high = std::max(majorStart, majorStart + major);
+	int majorMin = alongX ? minX : minY;
+	int majorMax = alongX ? maxX : maxY;
+	int minorMin = alongX ? minY : minX;
+	int minorMax = alongX ? maxY : maxX;
+
+	//Pixel centres c + 0.5 in [low, high)
+	int firstPixel = (int)std::max((float)majorMin, std::ceil(low - 0.5f));
+	int lastPixel = (int)std::min((float)majorMax, std::ceil(high - 0.5f) - 1.0f);
+	for (int pixel = firstPixel; pixel <= lastPixel; pixel++) {
+		float t = (pixel + 0.5f - majorStart) / major;
+		int minor = (int)std::floor(minorStart + t * major * slope);
+		if (minor < minorMin || minor > minorMax) {
+			continue;
+		}
+
+		std::uint32_t colour = flat ? start.colour : mixColours(startColour, endColour, t);
+		if (alongX) {
+			pixels[(std::size_t)minor * width + pixel] = colour;
+		} else {
+			pixels[(std::size_t)pixel * width + minor] = colour;
+		}
+	}
+}
+
+//Lights the pixels whose centres are inside or on the edge of the triangle. Pixels on an edge
+//two triangles share are drawn by both, which cannot be seen as nothing is blended.
+void SoftwareRasterizer::drawTriangle(std::uint32_t first, int minX, int minY, int maxX, int maxY) {
+	const ScreenVertex* corner0 = &vertices[first];
+	const ScreenVertex* corner1 = &vertices[first + 1];
+	const ScreenVertex* corner2 = &vertices[first + 2];
+	float area = (corner1->x - corner0->x) * (corner2->y - corner0->y) -
+		(corner2->x - corner0->x) * (corner1->y - corner0->y);
+	if (area == 0.0f || std::isnan(area)) {
+		return;
+	}
+	//Nothing is culled, so clockwise triangles are turned anticlockwise
+	if (area < 0.0f) {
+		std::swap(corner1, corner2);
+		area = -area;
+	}
+
+	int boundsMinX, boundsMinY, boundsMaxX, boundsMaxY;
+	getPixelBounds(first, 3, boundsMinX, boundsMinY, boundsMaxX, boundsMaxY);
+	minX = std::max(minX, boundsMinX);
+	minY = std::max(minY, boundsMinY);
+	maxX = std::min(maxX, boundsMaxX);
+	maxY = std::min(maxY, boundsMaxY);
+	if (maxX < minX || maxY < minY) {
+		return;
+	}
+
+	//Each edge is named after the corner opposite it, whose weight it gives
+	Edge edge0(corner1->x, corner1->y, corner2->x, corner2->y);
+	Edge edge1(corner2->x, corner2->y, corner0->x, corner0->y);
+	Edge edge2(corner0->x, corner0->y, corner1->x, corner1->y);
+
+	bool flat = corner0->colour == corner1->colour && corner1->colour == corner2->colour;
+	float colour0[3], colour1[3], colour2[3];
+	unpackColour(corner0->colour, colour0);
+	unpackColour(corner1->colour, colour1);
+	unpackColour(corner2->colour, colour2);
+	float inverseArea = 1.0f / area;
+
+	for (int y = minY; y <= maxY; y++) {
+		float centreY = y + 0.5f;
+		std::uint32_t* row = &pixels[(std::size_t)y * width];
+
+#ifdef RASTERIZER_SSE_EDGES
+		const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 rowEnd = _mm_set1_ps((float)maxX + 1.0f);
+		__m128 a0 = _mm_set1_ps(edge0.a), rowConstant0 = _mm_set1_ps(edge0.b * centreY + edge0.c);
+		__m128 a1 = _mm_set1_ps(edge1.a), rowConstant1 = _mm_set1_ps(edge1.b * centreY + edge1.c);
+		__m128 a2 = _mm_set1_ps(edge2.a), rowConstant2 = _mm_set1_ps(edge2.b * centreY + edge2.c);
+		for (int x = minX; x <= maxX; x += 4) {
+			__m128 centreX = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+			__m128 weight0 = _mm_add_ps(_mm_mul_ps(a0, centreX), rowConstant0);
+			__m128 weight1 = _mm_add_ps(_mm_mul_ps(a1, centreX), rowConstant1);
+			__m128 weight2 = _mm_add_ps(_mm_mul_ps(a2, centreX), rowConstant2);
+			__m128 inside = _mm_and_ps(_mm_cmpge_ps(weight0, zero), _mm_cmpge_ps(weight1, zero));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(weight2, zero));
+			inside = _mm_and_ps(inside, _mm_cmplt_ps(centreX, rowEnd));
+			int mask = _mm_movemask_ps(inside);
+			if (!mask) {
+				continue;
+			}
+
+			float weights0[4], weights1[4];
+			_mm_storeu_ps(weights0, weight0);
+			_mm_storeu_ps(weights1, weight1);
+			for (int lane = 0; lane < 4; lane++) {
+				if (!(mask & (1 << lane))) {
+					continue;
+				}
+				if (flat) {
+					row[x + lane] = corner0->colour;
+					continue;
+				}
+				float w0 = weights0[lane] * inverseArea;
+				float w1 = weights1[lane] * inverseArea;
+				float w2 = 1.0f - w0 - w1;
+				row[x + lane] = packChannels(colour0[0] * w0 + colour1[0] * w1 + colour2[0] * w2,
+					colour0[1] * w0 + colour1[1] * w1 + colour2[1] * w2,
+					colour0[2] * w0 + colour1[2] * w1 + colour2[2] * w2);
+			}
+		}
+#else
+		for (int x = minX; x <= maxX; x++) {
+			float centreX = x + 0.5f;
+			float weight0 = edge0.evaluate(centreX, centreY);
+			float weight1 = edge1.evaluate(centreX, centreY);
+			float weight2 = edge2.evaluate(centreX, centreY);
+			if (weight0 < 0.0f || weight1 < 0.0f || weight2 < 0.0f) {
+				continue;
+			}
+			if (flat) {
+				row[x] = corner0->colour;
+				continue;
+			}
+			float w0 = weight0 * inverseArea;
+			float w1 = weight1 * inverseArea;
+			float w2 = 1.0f - w0 - w1;
+			row[x] = packChannels(colour0[0] * w0 + colour1[0] * w1 + colour2[0] * w2,
+				colour0[1] * w0 + colour1[1] * w1 + colour2[1] * w2,
+				colour0[2] * w0 + colour1[2] * w1 + colour2[2] * w2);
+		}
+#endif
+	}
+}
+
+//Samples the nearest cell to each pixel centre, like the density texture, and looks its
+//colour up in a table of the 256 intensities
+void SoftwareRasterizer::drawDensity(const DensityHistogram& histogram, const glm::vec3& background) {
+	histogram.toneMap(densityIntensities);
+	int cellsX = histogram.getWidth();
+	int cellsY = histogram.getHeight();
+	if (cellsX <= 0 || cellsY <= 0) {
+		clear(background);
+		return;
+	}
+
+	std::uint32_t palette[256];
+	for (int intensity = 0; intensity < 256; intensity++) {
+		palette[intensity] = packColour(glm::mix(background, histogram.colour, intensity / 255.0f));
+	}
+	std::vector<int> columnCells(width);
+	for (int x = 0; x < width; x++) {
+		columnCells[x] = std::min((int)((x + 0.5f) / width * cellsX), cellsX - 1);
+	}
+
+	const unsigned char* intensities = densityIntensities.data();
+	const int* cells = columnCells.data();
+	ThreadTools::parallelFor(height, DENSITY_MINIMUM_ROWS,
+		[this, intensities, cells, &palette, cellsX, cellsY](std::size_t begin, std::size_t end, unsigned int) {
+			for (std::size_t y = begin; y < end; y++) {
+				int cellY = std::min((int)((y + 0.5f) / height * cellsY), cellsY - 1);
+				const unsigned char* cellRow = intensities + (std::size_t)cellY * cellsX;
+				std::uint32_t* row = &pixels[y * width];
+				for (int x = 0; x < width; x++) {
+					row[x] = palette[cellRow[cells[x]]];
+				}
+			}
+		});
+}
+
+bool SoftwareRasterizer::writeImage(const std::string& path) const {
+	std::ofstream out(path.c_str(), std::ios::binary);
+	if (!out.is_open()) {
+		return false;
+	}
+
+	out << "P6\n" << width << " " << height << "\n255\n";
+	std::vector<char> row(3 * (std::size_t)width);
+	for (int y = height - 1; y >= 0; y--) {
+		const std::uint32_t* source = &pixels[(std::size_t)y * width];
+		for (int x = 0; x < width; x++) {
+			row[3 * x] = (char)(source[x] & 0xFF);
+			row[3 * x + 1] = (char)((source[x] >> 8) & 0xFF);
+			row[3 * x + 2] = (char)((source[x] >> 16) & 0xFF);
+		}
+		out.write(row.data(), row.size());
+	}
+	return out.good();
+}
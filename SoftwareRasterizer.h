@@ -0,0 +1,113 @@
+/*
+ * SoftwareRasterizer.h
+ *	Draws scene geometry on the CPU, the way RenderScene draws it with OpenGL, into an RGBA8
+ *	image. Primitives are binned into screen tiles, and the tiles are rasterized by worker
+ *	threads, with triangle edge functions evaluated four pixels at a time. Density histograms
+ *	are tone-mapped into the image the way RenderDensity draws them. Needs no context.
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef SOFTWARERASTERIZER_H_
+#define SOFTWARERASTERIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "DensityHistogram.h"
+#include "Geometry.h"
+
+class SoftwareRasterizer {
+public:
+	SoftwareRasterizer();
+
+	void resize(int width, int height);
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+
+	void clear(const glm::vec3& colour);
+
+	//Draws GL_POINTS, GL_LINES, GL_LINE_STRIP and GL_TRIANGLES geometry, instanced or not, in
+	//order, with 1 pixel points and lines. Like the shaders, positions are taken as x and y in
+	//[-1, 1] and colours are not blended.
+	void draw(const std::vector<Geometry>& objects);
+
+	//Fills the image with the tone-mapped histogram stretched over it, mixing from background
+	//to the histogram's colour with intensity, as the density shader does
+	void drawDensity(const DensityHistogram& histogram, const glm::vec3& background);
+
+	//Packed R, G, B, A bytes, bottom row first (as glTexImage2D expects)
+	const std::vector<std::uint32_t>& getPixels() const { return pixels; }
+
+	//Writes the image as a binary PPM, top row first
+	bool writeImage(const std::string& path) const;
+
+	//Tiles are this many pixels square
+	static const int TILE_SIZE = 64;
+
+private:
+	//Window coordinates, y up, and packed colour
+	struct ScreenVertex {
+		float x;
+		float y;
+		std::uint32_t colour;
+	};
+
+	enum PrimitiveKind {
+		POINT_PRIMITIVE,
+		LINE_PRIMITIVE,
+		TRIANGLE_PRIMITIVE
+	};
+
+	//Primitives of one kind drawn from consecutive vertices: count of them, each starting
+	//stride vertices after the last, from first on. Runs are added in draw order and their
+	//vertices never overlap, so a primitive's first vertex also gives its place in the order.
+	struct PrimitiveRun {
+		std::uint32_t first;
+		std::uint32_t count;
+		std::uint32_t stride;
+		std::uint32_t kind;
+	};
+
+	//Tiles list primitives as their first vertex, with the kind in the top bits, so a point
+	//costs one index in the tile it falls in and nothing else
+	static const int KIND_SHIFT = 30;
+	static const std::uint32_t VERTEX_MASK = (1u << KIND_SHIFT) - 1;
+
+	//Transforms vertices [0, count) of the geometry to window coordinates, applying an
+	//instance's transform and colour offset if given
+	void addVertices(const Geometry& geometry, const glm::mat3* transform, const glm::vec3& colourOffset);
+	//Adds the primitives of count vertices from first on, drawn with drawMode
+	void addPrimitives(GLuint drawMode, std::uint32_t first, std::uint32_t count);
+
+	void binPrimitives();
+	//Bins the primitives of the run that start on vertices [begin, end)
+	void binRun(const PrimitiveRun& run, std::size_t begin, std::size_t end,
+		std::vector<std::vector<std::uint32_t> >& sliceBins) const;
+	void rasterizeTile(int tile);
+	void drawPoint(std::uint32_t first, int minX, int minY, int maxX, int maxY);
+	void drawLine(std::uint32_t first, int minX, int minY, int maxX, int maxY);
+	void drawTriangle(std::uint32_t first, int minX, int minY, int maxX, int maxY);
+
+	//Pixel bounds of the primitive of vertexCount vertices from first on, as inclusive pixel
+	//indices (empty if maxX < minX or maxY < minY)
+	void getPixelBounds(std::uint32_t first, int vertexCount, int& minX, int& minY, int& maxX, int& maxY) const;
+
+	int width;
+	int height;
+	int tilesX;
+	int tilesY;
+	std::vector<std::uint32_t> pixels;
+
+	//The frame being drawn, kept between frames for their capacity
+	std::vector<ScreenVertex> vertices;
+	std::vector<PrimitiveRun> runs;
+	//Primitives per binning slice, then per tile; slices cover consecutive vertices, so
+	//reading them in order keeps the draw order
+	std::vector<std::vector<std::vector<std::uint32_t> > > bins;
+	//Tone-mapped cells of the last histogram drawn
+	std::vector<unsigned char> densityIntensities;
+};
+
+#endif /* SOFTWARERASTERIZER_H_ */
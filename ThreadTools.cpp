@@ -0,0 +1,110 @@
+/*
+ * ThreadTools.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "ThreadTools.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace {
+	//0 for one worker per hardware thread
+	std::atomic<unsigned int> workerCountOverride(0);
+
+	//Set by the innermost CancelScope on this thread, or by the parallelFor that started it
+	thread_local const std::atomic<bool>* cancelFlag = 0;
+
+	//Nothing thrown may leave a slice, as it would end the program from a worker thread or skip
+	//joining them. A parallelFor nested in the slice throws once it is cancelled, which is thrown
+	//again by the parallelFor running the slice; anything else is kept in error and rethrown by
+	//it once every slice has finished.
+	void runSlice(const std::function<void(std::size_t, std::size_t, unsigned int)>& work,
+		std::size_t begin, std::size_t end, unsigned int slice, std::exception_ptr& error) {
+		try {
+			work(begin, end, slice);
+		} catch (const ThreadTools::Cancelled&) {
+		} catch (...) {
+			error = std::current_exception();
+		}
+	}
+}
+
+unsigned int ThreadTools::getWorkerCount() {
+	unsigned int workers = workerCountOverride.load(std::memory_order_relaxed);
+	if (workers == 0) {
+		workers = std::thread::hardware_concurrency();
+	}
+	return workers > 0 ? workers : 1;
+}
+
+void ThreadTools::setWorkerCount(unsigned int count) {
+	workerCountOverride.store(count, std::memory_order_relaxed);
+}
+
+void ThreadTools::parallelFor(std::size_t count, std::size_t minimumSliceSize,
+	const std::function<void(std::size_t, std::size_t, unsigned int)>& work) {
+	if (count == 0) return;
+	throwIfCancelled();
+
+	std::size_t maximumSlices = count / std::max<std::size_t>(minimumSliceSize, 1);
+	std::size_t sliceCount = std::max<std::size_t>(1, std::min<std::size_t>(getWorkerCount(), maximumSlices));
+	std::size_t sliceSize = (count + sliceCount - 1) / sliceCount;
+
+	//Slice 0 runs on the calling thread, the rest get a thread each. Each slice has its own
+	//error, so they are written without a lock.
+	const std::atomic<bool>* flag = cancelFlag;
+	std::vector<std::exception_ptr> errors(sliceCount);
+	std::vector<std::thread> workers;
+	try {
+		workers.reserve(sliceCount - 1);
+		for (std::size_t slice = 1; slice < sliceCount; slice++) {
+			std::size_t begin = slice * sliceSize;
+			std::size_t end = std::min(count, begin + sliceSize);
+			if (begin >= end) break;
+			std::exception_ptr& error = errors[slice];
+			workers.push_back(std::thread([&work, &error, flag, begin, end, slice]() {
+				cancelFlag = flag;
+				runSlice(work, begin, end, static_cast<unsigned int>(slice), error);
+			}));
+		}
+	} catch (...) {
+		//A slice that could not be started leaves the output incomplete, so slice 0 is skipped
+		errors[0] = std::current_exception();
+	}
+	if (!errors[0]) {
+		runSlice(work, 0, std::min(count, sliceSize), 0, errors[0]);
+	}
+
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	for (const std::exception_ptr& error : errors) {
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+	throwIfCancelled();
+}
+
+ThreadTools::CancelScope::CancelScope(const std::atomic<bool>* flag) : previousFlag(cancelFlag) {
+	cancelFlag = flag;
+}
+
+ThreadTools::CancelScope::~CancelScope() {
+	cancelFlag = previousFlag;
+}
+
+bool ThreadTools::isCancelled() {
+	return cancelFlag && cancelFlag->load(std::memory_order_relaxed);
+}
+
+void ThreadTools::throwIfCancelled() {
+	if (isCancelled()) {
+		throw Cancelled();
+	}
+}
@@ -0,0 +1,49 @@
+/*
+ * ThreadTools.h
+ *	Small helpers for splitting CPU work across worker threads
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef THREADTOOLS_H_
+#define THREADTOOLS_H_
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+//Thread associated functions are put in the ThreadTools namespace
+namespace ThreadTools {
+
+	//Number of workers to use for parallel generation (at least 1)
+	unsigned int getWorkerCount();
+	//Overrides the worker count, e.g. for benchmarks; 0 goes back to one per hardware thread
+	void setWorkerCount(unsigned int count);
+
+	//Splits [0, count) into one contiguous slice per worker and runs work(begin, end, workerIndex) on each.
+	//Slices are never smaller than minimumSliceSize, so small jobs stay on the calling thread.
+	//Returns once every slice has finished. Slices inherit the calling thread's cancellation, and
+	//once they have all finished it rethrows the first exception a slice threw (or starting a
+	//thread did), or throws Cancelled if the work was cancelled.
+	void parallelFor(std::size_t count, std::size_t minimumSliceSize,
+		const std::function<void(std::size_t, std::size_t, unsigned int)>& work);
+
+	//Thrown out of work that was cancelled part way, whose output is then incomplete
+	struct Cancelled {};
+
+	//Work run on this thread while the scope is alive, including parallelFor slices it starts, is
+	//cancelled once `flag` is set. Long loops poll isCancelled() at points they can stop at.
+	class CancelScope {
+	public:
+		explicit CancelScope(const std::atomic<bool>* flag);
+		~CancelScope();
+
+	private:
+		const std::atomic<bool>* previousFlag;
+	};
+
+	bool isCancelled();
+	//Throws Cancelled if the work on this thread has been cancelled
+	void throwIfCancelled();
+}
+
+#endif /* THREADTOOLS_H_ */
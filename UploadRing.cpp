@@ -0,0 +1,138 @@
+/*
+ * UploadRing.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "UploadRing.h"
+
+#include <algorithm>
+#include <iostream>
+
+//GL 4.4 / GL_ARB_buffer_storage names the 4.0 loader doesn't know
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace {
+	typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+	//Keeps every allocation aligned for any attribute type
+	const GLintptr RING_ALIGNMENT = 16;
+
+	//Waits for the GPU to pass a fence, then deletes it
+	void waitForFence(GLsync& fence) {
+		if (!fence) return;
+		GLenum status;
+		do {
+			status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+		} while (status == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(fence);
+		fence = 0;
+	}
+}
+
+UploadRing::UploadRing(GLsizeiptr ringSize)
+	: ringSize(ringSize), initialised(false), ringBuffer(0), ringData(0), segmentSize(ringSize / SEGMENT_COUNT),
+	segment(0), head(0) {
+	std::fill(fences, fences + SEGMENT_COUNT, (GLsync)0);
+}
+
+UploadRing::~UploadRing() {
+	//The context may already be gone at exit, so the ring is left for it to clean up
+}
+
+bool UploadRing::isPersistent() {
+	initialise();
+	return ringData != 0;
+}
+
+void UploadRing::initialise() {
+	if (initialised) return;
+	initialised = true;
+
+	BufferStorageProc bufferStorage = 0;
+	if (glfwExtensionSupported("GL_ARB_buffer_storage")) {
+		bufferStorage = (BufferStorageProc)glfwGetProcAddress("glBufferStorage");
+	}
+	if (!bufferStorage) {
+		std::cout << "No GL_ARB_buffer_storage, uploading through unsynchronized buffer maps" << std::endl;
+		return;
+	}
+
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glGenBuffers(1, &ringBuffer);
+	glBindBuffer(GL_COPY_READ_BUFFER, ringBuffer);
+	bufferStorage(GL_COPY_READ_BUFFER, ringSize, 0, flags);
+	ringData = (unsigned char*)glMapBufferRange(GL_COPY_READ_BUFFER, 0, ringSize, flags);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	if (!ringData) {
+		std::cout << "Could not map the upload ring, uploading through unsynchronized buffer maps" << std::endl;
+		glDeleteBuffers(1, &ringBuffer);
+		ringBuffer = 0;
+	}
+}
+
+void UploadRing::write(GLuint destination, GLintptr offset, std::size_t count, GLsizei stride, const Fill& fill) {
+	initialise();
+	if (count == 0) return;
+	if (!ringData) {
+		writeMapped(destination, offset, count, stride, fill);
+		return;
+	}
+
+	//Whole elements per run, as many as fit in one segment
+	std::size_t elementsPerRun = std::max<std::size_t>(1, segmentSize / stride);
+	glBindBuffer(GL_COPY_READ_BUFFER, ringBuffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, destination);
+	for (std::size_t first = 0; first < count; first += elementsPerRun) {
+		std::size_t runCount = std::min(elementsPerRun, count - first);
+		GLsizeiptr runSize = runCount * stride;
+		GLintptr ringOffset;
+		unsigned char* out = allocate(runSize, ringOffset);
+		fill(out, first, runCount);
+		//The ring is coherent, so the copy sees what was just written
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, ringOffset, offset + first * stride, runSize);
+	}
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+unsigned char* UploadRing::allocate(GLsizeiptr size, GLintptr& ringOffset) {
+	GLintptr segmentEnd = (segment + 1) * segmentSize;
+	head = (head + RING_ALIGNMENT - 1) / RING_ALIGNMENT * RING_ALIGNMENT;
+	if (head + size > segmentEnd) {
+		//Fence the copies out of this segment, and move on to the next once the GPU is done with it
+		fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		segment = (segment + 1) % SEGMENT_COUNT;
+		waitForFence(fences[segment]);
+		head = segment * segmentSize;
+	}
+
+	ringOffset = head;
+	head += size;
+	return ringData + ringOffset;
+}
+
+void UploadRing::writeMapped(GLuint destination, GLintptr offset, std::size_t count, GLsizei stride, const Fill& fill) {
+	GLsizeiptr size = count * stride;
+	glBindBuffer(GL_COPY_WRITE_BUFFER, destination);
+	GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+	unsigned char* out = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size, access);
+	if (out) {
+		fill(out, 0, count);
+		if (glUnmapBuffer(GL_COPY_WRITE_BUFFER)) {
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			return;
+		}
+	}
+
+	//The map failed or its contents were lost: fall back to a staging copy
+	std::vector<unsigned char> staging(size);
+	fill(staging.data(), 0, count);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, staging.data());
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
@@ -0,0 +1,60 @@
+/*
+ * UploadRing.h
+ *	Streams vertex data into vbos without a staging vector or a blocking glBufferData.
+ *	Where GL_ARB_buffer_storage is available, data is written into a persistently mapped ring
+ *	and copied on the GPU, with fences keeping the writer off regions still being copied.
+ *	Otherwise (plain 4.1) the destination range is mapped unsynchronized and written in place.
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef UPLOADRING_H_
+#define UPLOADRING_H_
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+//**Must include glad and GLFW in this order or it breaks**
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+class UploadRing {
+public:
+	//Writes elements [first, first + count) to out
+	typedef std::function<void(unsigned char* out, std::size_t first, std::size_t count)> Fill;
+
+	explicit UploadRing(GLsizeiptr ringSize);
+	~UploadRing();
+
+	//Writes count elements of stride bytes into destination from byte offset on, calling fill
+	//for each run of elements with where they go. The range written must not be in use by
+	//queued draws unless the ring is persistent (orphan or newly allocate it first).
+	void write(GLuint destination, GLintptr offset, std::size_t count, GLsizei stride, const Fill& fill);
+
+	//Whether the persistent ring is in use (needs a current context; checked on first write)
+	bool isPersistent();
+
+	//GPU storage the ring holds (none until the first write, or without a persistent ring)
+	GLsizeiptr getByteSize() const { return ringBuffer ? ringSize : 0; }
+
+private:
+	//The ring is split into segments, each fenced once it is full
+	static const int SEGMENT_COUNT = 4;
+
+	void initialise();
+	//Room for size bytes in the ring: a pointer to write to and its offset in the ring buffer
+	unsigned char* allocate(GLsizeiptr size, GLintptr& ringOffset);
+	void writeMapped(GLuint destination, GLintptr offset, std::size_t count, GLsizei stride, const Fill& fill);
+
+	GLsizeiptr ringSize;
+	bool initialised;
+
+	GLuint ringBuffer;
+	unsigned char* ringData;
+	GLsizeiptr segmentSize;
+	int segment;
+	GLintptr head;
+	GLsync fences[SEGMENT_COUNT];
+};
+
+#endif /* UPLOADRING_H_ */
@@ -0,0 +1,142 @@
+/*
+ * VertexLayout.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "VertexLayout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+	//Float to IEEE half, rounding to nearest even; too large becomes infinity
+	std::uint16_t toHalf(float value) {
+		std::uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		std::uint16_t sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000);
+		std::uint32_t magnitude = bits & 0x7fffffff;
+
+		if (magnitude >= 0x47800000) {
+			//65536 and up, infinity or NaN
+			return sign | ((magnitude > 0x7f800000) ? 0x7e00 : 0x7c00);
+		}
+		if (magnitude < 0x38800000) {
+			//Below the smallest normal half: a multiple of 2^-24
+			float absolute;
+			std::memcpy(&absolute, &magnitude, sizeof(absolute));
+			return sign | static_cast<std::uint16_t>(std::nearbyint(absolute * 16777216.0f));
+		}
+		//Rebias the exponent from 127 to 15 and round the mantissa from 23 bits to 10
+		std::uint32_t rounded = magnitude - 0x38000000 + 0xfff + ((magnitude >> 13) & 1);
+		return sign | static_cast<std::uint16_t>(rounded >> 13);
+	}
+
+	std::int16_t toSnorm16(float value) {
+		return static_cast<std::int16_t>(std::nearbyint(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f));
+	}
+
+	std::uint8_t toUnorm8(float value) {
+		return static_cast<std::uint8_t>(std::nearbyint(std::min(std::max(value, 0.0f), 1.0f) * 255.0f));
+	}
+
+	//The format is switched on once per call, not once per vertex
+	void packPositions(PositionFormat format, const glm::vec3* verts, std::size_t count, unsigned char* out,
+		GLsizei stride) {
+		switch (format) {
+		case FLOAT3_POSITION:
+			for (std::size_t i = 0; i < count; i++, out += stride) {
+				float position[3] = { verts[i][0], verts[i][1], verts[i][2] };
+				std::memcpy(out, position, sizeof(position));
+			}
+			break;
+		case FLOAT2_POSITION:
+			for (std::size_t i = 0; i < count; i++, out += stride) {
+				float position[2] = { verts[i][0], verts[i][1] };
+				std::memcpy(out, position, sizeof(position));
+			}
+			break;
+		case HALF2_POSITION:
+			for (std::size_t i = 0; i < count; i++, out += stride) {
+				std::uint16_t position[2] = { toHalf(verts[i][0]), toHalf(verts[i][1]) };
+				std::memcpy(out, position, sizeof(position));
+			}
+			break;
+		case SNORM16X2_POSITION:
+			for (std::size_t i = 0; i < count; i++, out += stride) {
+				std::int16_t position[2] = { toSnorm16(verts[i][0]), toSnorm16(verts[i][1]) };
+				std::memcpy(out, position, sizeof(position));
+			}
+			break;
+		}
+	}
+
+	void packColours(ColourFormat format, const glm::vec3* colors, std::size_t count, unsigned char* out,
+		GLsizei stride) {
+		switch (format) {
+		case FLOAT3_COLOUR:
+			for (std::size_t i = 0; i < count; i++, out += stride) {
+				float colour[3] = { colors[i][0], colors[i][1], colors[i][2] };
+				std::memcpy(out, colour, sizeof(colour));
+			}
+			break;
+		case UNORM8X4_COLOUR:
+			for (std::size_t i = 0; i < count; i++, out += stride) {
+				std::uint8_t colour[4] = { toUnorm8(colors[i][0]), toUnorm8(colors[i][1]), toUnorm8(colors[i][2]), 255 };
+				std::memcpy(out, colour, sizeof(colour));
+			}
+			break;
+		}
+	}
+}
+
+AttributeFormat VertexLayout::getPositionFormat() const {
+	switch (position) {
+	case FLOAT2_POSITION:
+		return AttributeFormat{ 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float) };
+	case HALF2_POSITION:
+		return AttributeFormat{ 2, GL_HALF_FLOAT, GL_FALSE, 2 * sizeof(std::uint16_t) };
+	case SNORM16X2_POSITION:
+		return AttributeFormat{ 2, GL_SHORT, GL_TRUE, 2 * sizeof(std::int16_t) };
+	case FLOAT3_POSITION:
+	default:
+		return AttributeFormat{ 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float) };
+	}
+}
+
+AttributeFormat VertexLayout::getColourFormat() const {
+	switch (colour) {
+	case UNORM8X4_COLOUR:
+		return AttributeFormat{ 4, GL_UNSIGNED_BYTE, GL_TRUE, 4 * sizeof(std::uint8_t) };
+	case FLOAT3_COLOUR:
+	default:
+		return AttributeFormat{ 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float) };
+	}
+}
+
+GLsizei VertexLayout::getVertexStride() const {
+	return getPositionFormat().size + (interleaved ? getColourFormat().size : 0);
+}
+
+GLsizei VertexLayout::getColourStride() const {
+	return interleaved ? 0 : getColourFormat().size;
+}
+
+GLsizei VertexLayout::getColourOffset() const {
+	return interleaved ? getPositionFormat().size : 0;
+}
+
+void packVertexData(const VertexLayout& layout, const glm::vec3* verts, const glm::vec3* colors, std::size_t count,
+	unsigned char* out) {
+	GLsizei stride = layout.getVertexStride();
+	packPositions(layout.position, verts, count, out, stride);
+	if (layout.interleaved) {
+		packColours(layout.colour, colors, count, out + layout.getColourOffset(), stride);
+	}
+}
+
+void packColourData(const VertexLayout& layout, const glm::vec3* colors, std::size_t count, unsigned char* out) {
+	packColours(layout.colour, colors, count, out, layout.getColourStride());
+}
@@ -0,0 +1,79 @@
+/*
+ * VertexLayout.h
+ *	How a geometry's vertices are stored in its vbos. Geometry always keeps float positions and
+ *	colours on the CPU; the layout decides how compactly they are packed for the GPU, and the
+ *	vertex attributes are set up from it.
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef VERTEXLAYOUT_H_
+#define VERTEXLAYOUT_H_
+
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+//**Must include glad and GLFW in this order or it breaks**
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+enum PositionFormat {
+	FLOAT3_POSITION,
+	//z is dropped (the attribute reads it back as 0)
+	FLOAT2_POSITION,
+	HALF2_POSITION,
+	//Only for positions inside [-1, 1]; anything outside is clamped
+	SNORM16X2_POSITION
+};
+
+enum ColourFormat {
+	FLOAT3_COLOUR,
+	//Normalised bytes with alpha 255
+	UNORM8X4_COLOUR
+};
+
+//How one vertex attribute is read from its vbo
+struct AttributeFormat {
+	GLint components;
+	GLenum type;
+	GLboolean normalized;
+	//Bytes per vertex
+	GLsizei size;
+};
+
+struct VertexLayout {
+	PositionFormat position;
+	ColourFormat colour;
+	//Positions and colours interleaved in the vertex buffer, rather than in separate vbos
+	bool interleaved;
+
+	AttributeFormat getPositionFormat() const;
+	AttributeFormat getColourFormat() const;
+
+	//Bytes per vertex in the vertex buffer and in the colour buffer (0 when interleaved)
+	GLsizei getVertexStride() const;
+	GLsizei getColourStride() const;
+	//Offset of the colour within an interleaved vertex
+	GLsizei getColourOffset() const;
+};
+
+//The layouts scenes choose from, fixed at compile time
+namespace VertexLayouts {
+	//The original layout: float xyz and float rgb in separate vbos, 24 bytes a vertex
+	const VertexLayout FULL = { FLOAT3_POSITION, FLOAT3_COLOUR, false };
+	//Float xy and rgba8, interleaved: 12 bytes a vertex
+	const VertexLayout COMPACT = { FLOAT2_POSITION, UNORM8X4_COLOUR, true };
+	//Half float xy and rgba8, interleaved: 8 bytes a vertex, for scenes reaching past [-1, 1]
+	const VertexLayout HALF = { HALF2_POSITION, UNORM8X4_COLOUR, true };
+	//16-bit snorm xy and rgba8, interleaved: 8 bytes a vertex, for scenes inside [-1, 1]
+	const VertexLayout QUANTIZED = { SNORM16X2_POSITION, UNORM8X4_COLOUR, true };
+}
+
+//Packs count vertices of the vertex buffer, getVertexStride() bytes each: the positions,
+//and the colours too when the layout is interleaved
+void packVertexData(const VertexLayout& layout, const glm::vec3* verts, const glm::vec3* colors, std::size_t count,
+	unsigned char* out);
+//Packs count vertices of the separate colour buffer, getColourStride() bytes each
+void packColourData(const VertexLayout& layout, const glm::vec3* colors, std::size_t count, unsigned char* out);
+
+#endif /* VERTEXLAYOUT_H_ */
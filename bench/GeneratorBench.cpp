@@ -0,0 +1,547 @@
+/*
+ * GeneratorBench.cpp
+ *	Headless benchmark of the geometry generators across levels and worker thread counts.
+ *	Prints throughput, peak RSS and allocation counts as JSON. Build and run with make bench.
+ *	With --raster it also times drawing each level with the software rasterizer, and with
+ *	--backend it times the fern generators on each fern kernel backend.
+ *  Created on: Oct 17, 2026
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "GeometryBuilder.h"
+#include "DensityHistogram.h"
+#include "FernKernels.h"
+#include "Geometry.h"
+#include "SoftwareRasterizer.h"
+#include "ThreadTools.h"
+
+namespace {
+	std::atomic<std::size_t> allocationCount(0);
+	std::atomic<std::size_t> allocatedBytes(0);
+}
+
+//Every allocation in the process is counted, including those on generator worker threads
+void* operator new(std::size_t size) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	void* memory = std::malloc(size ? size : 1);
+	if (!memory) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void operator delete(void* memory) noexcept {
+	std::free(memory);
+}
+
+namespace {
+	const int DENSITY_GRID_SIZE = 512;
+
+	//One generator at one level. prepare runs before each timed run, untimed; run returns
+	//the number of vertices the level is made of. getGeometry gives the last level run as
+	//drawable geometry (unset for generators that do not make any).
+	struct BenchCase {
+		std::function<void(int)> prepare;
+		std::function<std::size_t(int)> run;
+		std::function<void(std::vector<Geometry>&)> getGeometry;
+	};
+
+	struct Generator {
+		Generator() : usesFernBackend(false) {}
+
+		std::string name;
+		std::vector<int> levels;
+		std::function<BenchCase()> makeCase;
+		//Whether it is run once per --backend
+		bool usesFernBackend;
+	};
+
+	struct Options {
+		Options() : repeat(5), warmup(1), rasterSize(0) {}
+
+		int repeat;
+		int warmup;
+		std::vector<unsigned int> threads;
+		std::vector<int> levels;
+		std::string generator;
+		//Side of the square image levels are rasterized into (0 skips rasterizing), and
+		//where the images are written as PPMs (nowhere if empty)
+		int rasterSize;
+		std::string imageDirectory;
+		//Fern kernel backends the fern generators are run on
+		std::vector<FernKernels::Backend> backends;
+	};
+
+	struct Timing {
+		double min;
+		double median;
+		double mean;
+		double max;
+	};
+
+	Timing summarise(std::vector<double> seconds) {
+		std::sort(seconds.begin(), seconds.end());
+		double total = 0.0;
+		for (double value : seconds) {
+			total += value;
+		}
+
+		Timing timing;
+		timing.min = seconds.front();
+		timing.max = seconds.back();
+		timing.mean = total / seconds.size();
+		timing.median = seconds[seconds.size() / 2];
+		if (seconds.size() % 2 == 0) {
+			timing.median = 0.5 * (timing.median + seconds[seconds.size() / 2 - 1]);
+		}
+		return timing;
+	}
+
+	void writeTiming(const Timing& timing, std::ostream& out) {
+		out << "{\"min\":" << timing.min << ",\"median\":" << timing.median
+			<< ",\"mean\":" << timing.mean << ",\"max\":" << timing.max << "}";
+	}
+
+	//Same mapping as RenderingEngine::getDrawMode, which cannot be linked without a GL context
+	GLuint getDrawMode(PrimitiveType primitive) {
+		switch (primitive) {
+		case LINE_STRIP_PRIMITIVE:
+			return GL_LINE_STRIP;
+		case TRIANGLES_PRIMITIVE:
+			return GL_TRIANGLES;
+		case LINES_PRIMITIVE:
+			return GL_LINES;
+		case POINTS_PRIMITIVE:
+		default:
+			return GL_POINTS;
+		}
+	}
+
+	Geometry makeGeometry(const GeometryData& data) {
+		Geometry geometry;
+		geometry.verts = data.verts;
+		geometry.colors = data.colors;
+		geometry.drawMode = getDrawMode(data.primitive);
+		return geometry;
+	}
+
+	void addGeometry(const std::vector<GeometryData>& objects, std::vector<Geometry>& geometry) {
+		for (const GeometryData& object : objects) {
+			geometry.push_back(makeGeometry(object));
+		}
+	}
+
+	void addGeometry(const InstancedGeometryData& instanced, const std::vector<GeometryData>& objects,
+		std::vector<Geometry>& geometry) {
+		geometry.push_back(makeGeometry(instanced.base));
+		geometry.back().instanceCount = instanced.transforms.size();
+		geometry.back().instanceTransforms = instanced.transforms;
+		geometry.back().instanceColourOffsets = instanced.colourOffsets;
+		addGeometry(objects, geometry);
+	}
+
+	std::size_t countVertices(const std::vector<GeometryData>& objects) {
+		std::size_t vertices = 0;
+		for (const GeometryData& object : objects) {
+			vertices += object.verts.size();
+		}
+		return vertices;
+	}
+
+	//Vertices drawn, counting the base once per copy
+	std::size_t countVertices(const InstancedGeometryData& instanced, const std::vector<GeometryData>& objects) {
+		return instanced.base.verts.size() * instanced.transforms.size() + countVertices(objects);
+	}
+
+	//A case for a builder that fills a vector of objects from scratch
+	Generator makeGenerator(const std::string& name, const std::vector<int>& levels,
+		void (*build)(int, std::vector<GeometryData>&)) {
+		Generator generator;
+		generator.name = name;
+		generator.levels = levels;
+		generator.makeCase = [build]() {
+			std::shared_ptr<std::vector<GeometryData> > objects = std::make_shared<std::vector<GeometryData> >();
+			BenchCase benchCase;
+			benchCase.prepare = [objects](int) { objects->clear(); };
+			benchCase.run = [build, objects](int level) {
+				build(level, *objects);
+				return countVertices(*objects);
+			};
+			benchCase.getGeometry = [objects](std::vector<Geometry>& geometry) { addGeometry(*objects, geometry); };
+			return benchCase;
+		};
+		return generator;
+	}
+
+	//A case for a builder that steps the previous level up to the next one; only the step is timed
+	Generator makeNextLevelGenerator(const std::string& name, const std::vector<int>& levels,
+		void (*build)(int, std::vector<GeometryData>&), void (*buildNextLevel)(int, std::vector<GeometryData>&)) {
+		Generator generator;
+		generator.name = name;
+		generator.levels = levels;
+		generator.makeCase = [build, buildNextLevel]() {
+			std::shared_ptr<std::vector<GeometryData> > objects = std::make_shared<std::vector<GeometryData> >();
+			BenchCase benchCase;
+			benchCase.prepare = [build, objects](int level) { build(level - 1, *objects); };
+			benchCase.run = [buildNextLevel, objects](int level) {
+				buildNextLevel(level, *objects);
+				return countVertices(*objects);
+			};
+			benchCase.getGeometry = [objects](std::vector<Geometry>& geometry) { addGeometry(*objects, geometry); };
+			return benchCase;
+		};
+		return generator;
+	}
+
+	Generator makeDensityGenerator(const std::string& name, const std::vector<int>& levels,
+		void (*build)(int, DensityHistogram&)) {
+		Generator generator;
+		generator.name = name;
+		generator.levels = levels;
+		generator.makeCase = [build]() {
+			std::shared_ptr<DensityHistogram> histogram = std::make_shared<DensityHistogram>(DENSITY_GRID_SIZE,
+				DENSITY_GRID_SIZE, -1.0f, -1.0f, 1.0f, 1.0f);
+			BenchCase benchCase;
+			benchCase.prepare = [](int) {};
+			benchCase.run = [build, histogram](int level) {
+				build(level, *histogram);
+				return histogram->getTotalPoints();
+			};
+			return benchCase;
+		};
+		return generator;
+	}
+
+	Generator makeInstancedGenerator(const std::string& name, const std::vector<int>& levels,
+		void (*build)(int, InstancedGeometryData&, std::vector<GeometryData>&)) {
+		Generator generator;
+		generator.name = name;
+		generator.levels = levels;
+		generator.makeCase = [build]() {
+			std::shared_ptr<InstancedGeometryData> instanced = std::make_shared<InstancedGeometryData>();
+			std::shared_ptr<std::vector<GeometryData> > objects = std::make_shared<std::vector<GeometryData> >();
+			BenchCase benchCase;
+			benchCase.prepare = [instanced, objects](int) {
+				*instanced = InstancedGeometryData();
+				objects->clear();
+			};
+			benchCase.run = [build, instanced, objects](int level) {
+				build(level, *instanced, *objects);
+				return countVertices(*instanced, *objects);
+			};
+			benchCase.getGeometry = [instanced, objects](std::vector<Geometry>& geometry) {
+				addGeometry(*instanced, *objects, geometry);
+			};
+			return benchCase;
+		};
+		return generator;
+	}
+
+	void buildSpiral(int numberOfIterations, std::vector<GeometryData>& objects) {
+		GeometryBuilder::buildSpiral(numberOfIterations, objects);
+	}
+
+	//Levels are picked per generator so each spans small to large outputs (up to tens of millions
+	//of vertices) without the slowest taking minutes
+	std::vector<Generator> getGenerators() {
+		std::vector<Generator> generators;
+		generators.push_back(makeGenerator("nested_squares", { 10, 100, 1000 }, GeometryBuilder::buildNestedSquares));
+		generators.push_back(makeGenerator("spiral", { 1, 10, 100 }, buildSpiral));
+		generators.push_back(makeGenerator("sierpinski_triangles", { 4, 8, 12 },
+			GeometryBuilder::buildSierpinskiTriangles));
+		generators.push_back(makeNextLevelGenerator("sierpinski_triangles_next_level", { 4, 8, 12 },
+			GeometryBuilder::buildSierpinskiTriangles, GeometryBuilder::buildSierpinskiTrianglesNextLevel));
+		generators.push_back(makeGenerator("random_sierpinski", { 100, 1000, 10000 },
+			GeometryBuilder::buildRandomSierpinski));
+		generators.push_back(makeDensityGenerator("random_sierpinski_density", { 100, 1000, 10000 },
+			GeometryBuilder::buildRandomSierpinskiDensity));
+		generators.push_back(makeGenerator("barnsley_fern", { 1, 4, 16 }, GeometryBuilder::buildBarnsleyFern));
+		generators.back().usesFernBackend = true;
+		generators.push_back(makeDensityGenerator("barnsley_fern_density", { 1, 4, 16 },
+			GeometryBuilder::buildBarnsleyFernDensity));
+		generators.back().usesFernBackend = true;
+		generators.push_back(makeGenerator("hilbert_curve", { 4, 8, 11 }, GeometryBuilder::buildHilbertCurve));
+		generators.push_back(makeNextLevelGenerator("hilbert_curve_next_level", { 4, 8, 11 },
+			GeometryBuilder::buildHilbertCurve, GeometryBuilder::buildHilbertCurveNextLevel));
+		generators.push_back(makeInstancedGenerator("nested_squares_instanced", { 10, 100, 1000 },
+			GeometryBuilder::buildNestedSquaresInstanced));
+		generators.push_back(makeInstancedGenerator("sierpinski_triangles_instanced", { 4, 8, 12 },
+			GeometryBuilder::buildSierpinskiTrianglesInstanced));
+		generators.push_back(makeInstancedGenerator("hilbert_curve_instanced", { 4, 8, 11 },
+			GeometryBuilder::buildHilbertCurveInstanced));
+		return generators;
+	}
+
+	//Starts measuring the peak resident set afresh from the current one, first handing memory
+	//freed by earlier cases back to the system so it is not counted again. Needs Linux's
+	//clear_refs; returns false where the peak can only be the whole process's.
+	bool resetPeakRss() {
+#ifdef __GLIBC__
+		malloc_trim(0);
+#endif
+		std::ofstream clearRefs("/proc/self/clear_refs");
+		clearRefs << "5" << std::flush;
+		return clearRefs.good();
+	}
+
+	//Largest resident set since resetPeakRss, or of the process so far if it could not be reset, in KiB
+	long getPeakRssKiB() {
+		std::ifstream status("/proc/self/status");
+		std::string line;
+		while (std::getline(status, line)) {
+			if (line.compare(0, 6, "VmHWM:") == 0) {
+				return std::strtol(line.c_str() + 6, 0, 10);
+			}
+		}
+
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+		return usage.ru_maxrss / 1024;
+#else
+		return usage.ru_maxrss;
+#endif
+	}
+
+	template <typename T>
+	std::vector<T> parseList(const std::string& text) {
+		std::vector<T> values;
+		std::istringstream in(text);
+		std::string item;
+		while (std::getline(in, item, ',')) {
+			values.push_back((T)std::strtol(item.c_str(), 0, 10));
+		}
+		return values;
+	}
+
+	void printUsage() {
+		std::cerr << "Usage: GeneratorBench.out [--repeat N] [--warmup N] [--threads 1,2,4] [--levels 1,2,3]"
+			" [--generator NAME] [--raster SIZE] [--image-dir DIR]\n    [--backend all|scalar,avx2,avx512]" << std::endl;
+	}
+
+	//Backends named in a comma separated list, or every supported one for "all". Unsupported
+	//ones are left out, as the fern would fall back to scalar on them.
+	bool parseBackends(const std::string& text, std::vector<FernKernels::Backend>& backends) {
+		std::vector<FernKernels::Backend> named;
+		if (text == "all") {
+			named.assign(FernKernels::BACKENDS, FernKernels::BACKENDS + FernKernels::BACKEND_COUNT);
+		} else {
+			std::istringstream in(text);
+			std::string item;
+			while (std::getline(in, item, ',')) {
+				FernKernels::Backend backend;
+				if (!FernKernels::getBackendByName(item.c_str(), backend)) {
+					std::cerr << "Unknown backend " << item << std::endl;
+					return false;
+				}
+				named.push_back(backend);
+			}
+		}
+
+		backends.clear();
+		for (FernKernels::Backend backend : named) {
+			if (FernKernels::isSupported(backend)) {
+				backends.push_back(backend);
+			} else if (text != "all") {
+				std::cerr << "Skipping " << FernKernels::getBackendName(backend) << ", which this CPU does not support"
+					<< std::endl;
+			}
+		}
+		return !backends.empty();
+	}
+
+	bool parseOptions(int argc, char* argv[], Options& options) {
+		for (int i = 1; i < argc; i++) {
+			std::string option = argv[i];
+			if (i + 1 >= argc) {
+				return false;
+			}
+			std::string value = argv[++i];
+			if (option == "--repeat") {
+				options.repeat = std::max(1, std::atoi(value.c_str()));
+			} else if (option == "--warmup") {
+				options.warmup = std::max(0, std::atoi(value.c_str()));
+			} else if (option == "--threads") {
+				options.threads = parseList<unsigned int>(value);
+			} else if (option == "--levels") {
+				options.levels = parseList<int>(value);
+			} else if (option == "--generator") {
+				options.generator = value;
+			} else if (option == "--raster") {
+				options.rasterSize = std::max(0, std::atoi(value.c_str()));
+			} else if (option == "--image-dir") {
+				options.imageDirectory = value;
+			} else if (option == "--backend") {
+				if (!parseBackends(value, options.backends)) {
+					return false;
+				}
+			} else {
+				return false;
+			}
+		}
+
+		if (options.threads.empty()) {
+			options.threads.push_back(1);
+			unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+			if (hardwareThreads > 1) {
+				options.threads.push_back(hardwareThreads);
+			}
+		}
+		if (options.backends.empty()) {
+			options.backends.push_back(GeometryBuilder::getFernBackend());
+		}
+		return true;
+	}
+
+	//Times drawing the level the case last generated with the software rasterizer, on the worker
+	//count already set, and writes the timings and the peak resident set while drawing as a
+	//"raster" member of the case's JSON object
+	void rasterCase(const Generator& generator, int level, const BenchCase& benchCase, std::size_t vertices,
+		const Options& options, std::ostream& out) {
+		resetPeakRss();
+		std::vector<Geometry> geometry;
+		benchCase.getGeometry(geometry);
+		SoftwareRasterizer rasterizer;
+		rasterizer.resize(options.rasterSize, options.rasterSize);
+
+		std::vector<double> seconds;
+		for (int run = -options.warmup; run < options.repeat; run++) {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			rasterizer.clear(glm::vec3(0.2f, 0.2f, 0.2f));
+			rasterizer.draw(geometry);
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			if (run >= 0) {
+				seconds.push_back(elapsed.count());
+			}
+		}
+
+		if (!options.imageDirectory.empty()) {
+			std::ostringstream path;
+			path << options.imageDirectory << "/" << generator.name << "_" << level << ".ppm";
+			if (!rasterizer.writeImage(path.str())) {
+				std::cerr << "Could not write " << path.str() << std::endl;
+			}
+		}
+
+		Timing timing = summarise(seconds);
+		out << ",\"raster\":{\"size\":" << options.rasterSize << ",\"seconds\":";
+		writeTiming(timing, out);
+		out << ",\"verticesPerSecond\":" << (timing.median > 0.0 ? vertices / timing.median : 0.0)
+			<< ",\"peakRssKiB\":" << getPeakRssKiB() << "}";
+	}
+
+	//Times one generator at one level and thread count, on the fern backend already set, and
+	//writes its result as a JSON object
+	void runCase(const Generator& generator, int level, unsigned int threads, const Options& options,
+		std::ostream& out) {
+		ThreadTools::setWorkerCount(threads);
+		bool peakRssReset = resetPeakRss();
+		BenchCase benchCase = generator.makeCase();
+
+		for (int run = 0; run < options.warmup; run++) {
+			benchCase.prepare(level);
+			benchCase.run(level);
+		}
+
+		std::vector<double> seconds;
+		std::size_t vertices = 0;
+		std::size_t allocations = 0;
+		std::size_t bytes = 0;
+		for (int run = 0; run < options.repeat; run++) {
+			benchCase.prepare(level);
+
+			std::size_t allocationsBefore = allocationCount.load();
+			std::size_t bytesBefore = allocatedBytes.load();
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			vertices = benchCase.run(level);
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			allocations += allocationCount.load() - allocationsBefore;
+			bytes += allocatedBytes.load() - bytesBefore;
+			seconds.push_back(elapsed.count());
+		}
+
+		Timing timing = summarise(seconds);
+		double median = timing.median;
+
+		out << "{\"generator\":\"" << generator.name << "\",\"level\":" << level << ",\"threads\":" << threads;
+		if (generator.usesFernBackend) {
+			out << ",\"backend\":\"" << FernKernels::getBackendName(GeometryBuilder::getFernBackend()) << "\"";
+		}
+		out << ",\"vertices\":" << vertices << ",\"seconds\":";
+		writeTiming(timing, out);
+		out << ",\"pointsPerSecond\":" << (median > 0.0 ? vertices / median : 0.0)
+			<< ",\"nsPerVertex\":" << (vertices > 0 ? median * 1e9 / vertices : 0.0)
+			<< ",\"allocationsPerRun\":" << allocations / options.repeat
+			<< ",\"allocatedBytesPerRun\":" << bytes / options.repeat;
+		//Generation only, read before drawing resets it. Measured over the case alone where the
+		//peak could be reset, and the whole run so far otherwise
+		long peakRssKiB = getPeakRssKiB();
+		if (options.rasterSize > 0 && benchCase.getGeometry) {
+			rasterCase(generator, level, benchCase, vertices, options, out);
+		}
+		out << ",\"peakRssKiB\":" << peakRssKiB << ",\"peakRssScope\":\"" << (peakRssReset ? "case" : "process")
+			<< "\"}";
+	}
+}
+
+int main(int argc, char* argv[]) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		printUsage();
+		return 1;
+	}
+
+	std::cout.precision(9);
+	std::cout << "{\"repeat\":" << options.repeat << ",\"warmup\":" << options.warmup
+		<< ",\"hardwareThreads\":" << std::thread::hardware_concurrency() << ",\"results\":[";
+
+	bool first = true;
+	std::vector<Generator> generators = getGenerators();
+	for (const Generator& generator : generators) {
+		if (!options.generator.empty() && options.generator != generator.name) {
+			continue;
+		}
+
+		//Generators that do not use the fern kernels are run once, on whichever backend is set
+		std::size_t backendCount = generator.usesFernBackend ? options.backends.size() : 1;
+		const std::vector<int>& levels = options.levels.empty() ? generator.levels : options.levels;
+		for (std::size_t backend = 0; backend < backendCount; backend++) {
+			GeometryBuilder::setFernBackend(options.backends[backend]);
+			for (int level : levels) {
+				for (unsigned int threads : options.threads) {
+					std::cerr << generator.name << " level " << level << " on " << threads << " threads";
+					if (generator.usesFernBackend) {
+						std::cerr << " with " << FernKernels::getBackendName(options.backends[backend]);
+					}
+					std::cerr << std::endl;
+					std::cout << (first ? "\n" : ",\n");
+					runCase(generator, level, threads, options, std::cout);
+					first = false;
+				}
+			}
+		}
+	}
+	std::cout << "\n]}" << std::endl;
+	ThreadTools::setWorkerCount(0);
+	return 0;
+}
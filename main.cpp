@@ -5,9 +5,61 @@
  *      Author: John Hall
  */
 #include "Program.h"
+#include "FernKernels.h"
 
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+
 int main (int argc, char* argv[]) {
-	Program p;
+	//--record script.txt saves the session's key presses; --replay script.txt plays them back
+	//headlessly and reports timings, to the console or to --report report.json.
+	//--software draws with the software rasterizer from the start, and --fern-backend scalar, avx2
+	//or avx512 picks the kernel the fern is generated with. --cache-mb 512 sets how much memory
+	//recently shown levels are kept in.
+	ProgramOptions options;
+	for (int i = 1; i < argc; i++) {
+		std::string option = argv[i];
+		if (option == "--software") {
+			options.softwareRendering = true;
+		} else if (i + 1 == argc) {
+			std::cout << "Missing value for " << option << std::endl;
+			return 1;
+		} else if (option == "--record") {
+			options.recordPath = argv[++i];
+		} else if (option == "--replay") {
+			options.replayPath = argv[++i];
+		} else if (option == "--report") {
+			options.reportPath = argv[++i];
+		} else if (option == "--cache-mb") {
+			//A whole number of megabytes whose byte count fits a size_t; strtoul alone would
+			//accept junk as 0 and wrap negative numbers
+			const char* value = argv[++i];
+			char* end = 0;
+			errno = 0;
+			unsigned long megabytes = std::strtoul(value, &end, 10);
+			if (value[0] < '0' || value[0] > '9' || *end != '\0' || errno == ERANGE ||
+				megabytes > std::numeric_limits<std::size_t>::max() / (1024 * 1024)) {
+				std::cout << "Invalid cache size " << value << std::endl;
+				return 1;
+			}
+			options.levelCacheMegabytes = megabytes;
+		} else if (option == "--fern-backend") {
+			options.fernBackend = argv[++i];
+			FernKernels::Backend backend;
+			if (!FernKernels::getBackendByName(options.fernBackend.c_str(), backend)) {
+				std::cout << "Unknown fern backend " << options.fernBackend << std::endl;
+				return 1;
+			}
+		} else {
+			std::cout << "Unknown option " << option << std::endl;
+			return 1;
+		}
+	}
+
+	Program p(options);
 	p.start();
 	return 0;
 }
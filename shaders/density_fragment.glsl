@@ -0,0 +1,19 @@
+// ==========================================================================
+// Fragment program that colours a tone-mapped density histogram
+// ==========================================================================
+#version 410
+
+in vec2 TextureCoordinates;
+
+// log-scaled hit counts, 0 = empty cell and 1 = densest cell
+uniform sampler2D Density;
+uniform vec3 DensityColour;
+uniform vec3 BackgroundColour;
+
+out vec4 FragmentColour;
+
+void main()
+{
+    float intensity = texture(Density, TextureCoordinates).r;
+    FragmentColour = vec4(mix(BackgroundColour, DensityColour, intensity), 1.0);
+}
@@ -0,0 +1,15 @@
+// ==========================================================================
+// Vertex program for drawing a density histogram over the whole window
+// ==========================================================================
+#version 410
+
+out vec2 TextureCoordinates;
+
+void main()
+{
+    // one oversized triangle covering the viewport, built from the vertex index
+    // so no vertex buffers are needed
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    TextureCoordinates = corner;
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,13 @@
+// ==========================================================================
+// Fragment program for instanced geometry
+// ==========================================================================
+#version 410
+
+in vec3 Colour;
+
+out vec4 FragmentColour;
+
+void main()
+{
+    FragmentColour = vec4(Colour, 1.0);
+}
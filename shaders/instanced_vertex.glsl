@@ -0,0 +1,23 @@
+// ==========================================================================
+// Vertex program for geometry drawn as many transformed copies of one base
+// ==========================================================================
+#version 410
+
+// per-vertex attributes of the base geometry
+layout(location = 0) in vec3 VertexPosition;
+layout(location = 1) in vec3 VertexColour;
+
+// per-instance attributes (the transform takes locations 2 to 4)
+layout(location = 2) in mat3 InstanceTransform;
+layout(location = 5) in vec3 InstanceColourOffset;
+
+out vec3 Colour;
+
+void main()
+{
+    // positions are 2D points with w = 1 in the third component, so the
+    // transform's third column is the instance's translation
+    vec3 position = InstanceTransform * vec3(VertexPosition.xy, 1.0);
+    gl_Position = vec4(position.xy, 0.0, 1.0);
+    Colour = VertexColour + InstanceColourOffset;
+}